@@ -0,0 +1,101 @@
+/**
+ * bench_layout.c - Compare legality and candidate scans across cell layouts.
+ *
+ * For every square block geometry from 3x3 (9x9 boards) to 8x8 (64x64 boards),
+ * a solved board is built in both row-major and block-major layouts and timed
+ * under `board_is_legal`, then half of its cells are cleared and it is timed
+ * under `board_compute_all_candidates`. Times are reported per cell.
+ */
+
+#include "board.h"
+
+#include <stdio.h>
+#include <time.h>
+
+/**
+ * Approximate number of cells processed per measurement.
+ */
+#define BENCH_CELLS 20000000L
+
+static const char* layout_name(board_layout_t layout) {
+    return layout == BL_ROW_MAJOR ? "row-major" : "block-major";
+}
+
+/**
+ * Fill `board` with a valid solution, clearing every other cell if `sparse` is
+ * set.
+ */
+static void fill_board(board_t* board, int sparse) {
+    int block_size = board_block_size(board);
+    int row, col;
+
+    for (row = 0; row < block_size; row++) {
+        for (col = 0; col < block_size; col++) {
+            int value =
+                ((row % board->m) * board->n + row / board->m + col) %
+                    block_size +
+                1;
+
+            if (sparse && (row + col) % 2 == 0) {
+                value = 0;
+            }
+            board_set_value(board, row, col, value);
+        }
+    }
+}
+
+/**
+ * Convert the time elapsed since `start` to nanoseconds per cell.
+ */
+static double ns_per_cell(clock_t start, long iters, int block_size) {
+    double secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+    return secs * 1e9 / ((double)iters * block_size * block_size);
+}
+
+static void bench_geometry(int m, int n, board_layout_t layout) {
+    board_t board;
+    board_candidates_t candidates;
+
+    int block_size = m * n;
+    long iters = BENCH_CELLS / ((long)block_size * block_size);
+    long i;
+
+    clock_t start;
+    double legal_ns, candidates_ns;
+    int legal = 1;
+
+    board_init_layout(&board, m, n, layout);
+
+    fill_board(&board, 0);
+    start = clock();
+    for (i = 0; i < iters; i++) {
+        legal &= board_is_legal(&board);
+    }
+    legal_ns = ns_per_cell(start, iters, block_size);
+
+    fill_board(&board, 1);
+    start = clock();
+    for (i = 0; i < iters; i++) {
+        board_compute_all_candidates(&board, &candidates);
+        board_candidates_destroy(&candidates);
+    }
+    candidates_ns = ns_per_cell(start, iters, block_size);
+
+    printf("%2dx%-2d  %-11s  %13.2f  %18.2f%s\n", block_size, block_size,
+           layout_name(layout), legal_ns, candidates_ns,
+           legal ? "" : "  (illegal!)");
+
+    board_destroy(&board);
+}
+
+int main() {
+    int size;
+
+    printf("board  layout       legal ns/cell  candidates ns/cell\n");
+    for (size = 3; size <= 8; size++) {
+        bench_geometry(size, size, BL_ROW_MAJOR);
+        bench_geometry(size, size, BL_BLOCK_MAJOR);
+    }
+
+    return 0;
+}
@@ -11,6 +11,8 @@ find_library(GUROBI_LIBRARY
 include(FindPackageHandleStandardArgs)
 find_package_handle_standard_args(Gurobi DEFAULT_MSG GUROBI_LIBRARY GUROBI_INCLUDE_DIRS)
 
-add_library(Gurobi::Gurobi INTERFACE IMPORTED)
-target_include_directories(Gurobi::Gurobi INTERFACE ${GUROBI_INCLUDE_DIRS})
-target_link_libraries(Gurobi::Gurobi INTERFACE ${GUROBI_LIBRARY})
+if(Gurobi_FOUND AND NOT TARGET Gurobi::Gurobi)
+    add_library(Gurobi::Gurobi INTERFACE IMPORTED)
+    target_include_directories(Gurobi::Gurobi INTERFACE ${GUROBI_INCLUDE_DIRS})
+    target_link_libraries(Gurobi::Gurobi INTERFACE ${GUROBI_LIBRARY})
+endif()
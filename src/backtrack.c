@@ -1,96 +1,152 @@
 #include "backtrack.h"
 
+#include "bitset.h"
 #include "board.h"
-#include "bool.h"
 #include "checked_alloc.h"
-#include "list.h"
+#include "dlx.h"
+#include "search.h"
+#include <math.h>
 #include <stdlib.h>
-#include <string.h>
-
-typedef struct {
-    int idx;
-    int value;
-} backtrack_state_t;
-
-static void backtrack_state_push(list_t* stack, int idx) {
-    backtrack_state_t* state = checked_malloc(sizeof(backtrack_state_t));
-    state->idx = idx;
-    state->value = 0; /* `value` is incremented on every iteration, so start
-                         before the minimal one. */
-    list_push(stack, state);
+
+/**
+ * Two-sided 95% quantile of the normal distribution.
+ */
+#define ESTIMATE_Z 1.96
+
+long num_solutions(board_t* board) {
+    return num_solutions_engine(board, CE_SEARCH);
+}
+
+long num_solutions_cached(board_t* board, search_tt_t* tt) {
+    search_t search;
+    long count;
+
+    search_init(&search, board);
+    search_set_tt(&search, tt);
+    count = search_count(&search);
+    search_destroy(&search);
+
+    return count;
 }
 
-static void backtrack_state_pop(list_t* stack) { free(list_pop(stack)); }
+long num_solutions_limit(board_t* board, int limit) {
+    search_t search;
+    long count;
+
+    search_init(&search, board);
+    count = search_count_limit(&search, limit);
+    search_destroy(&search);
+
+    return count;
+}
+
+long num_solutions_engine(board_t* board, count_engine_t engine) {
+    long count;
+
+    if (engine == CE_DLX) {
+        dlx_t dlx;
+
+        dlx_init(&dlx, board);
+        count = dlx_count(&dlx);
+        dlx_destroy(&dlx);
+    } else {
+        search_t search;
+
+        search_init(&search, board);
+        count = search_count(&search);
+        search_destroy(&search);
+    }
 
-static backtrack_state_t* backtrack_state_top(list_t* stack) {
-    return stack->tail->value;
+    return count;
 }
 
 /**
- * Advance `idx` to the nearest empty cell, returning false if the end of the
- * board has been reached.
+ * Follow one random path down the search tree, returning the product of the
+ * candidate counts along it if it ends in a solution and 0 otherwise.
  */
-static bool_t advance_to_empty(const board_t* board, int* idx) {
-    int block_size = board_block_size(board);
+static double probe(search_t* search, bitset_word_t* candidates) {
+    double weight = 1;
+    int best;
+
+    search_reset(search);
+
+    if (!search_propagate(search, &best)) {
+        return 0;
+    }
+
+    while (best != -1) {
+        int candidate_count = search_candidates(search, best, candidates);
+        int pick;
+        int bit;
+
+        if (!candidate_count) {
+            return 0;
+        }
+
+        pick = rand() % candidate_count;
+        bit = bitset_next(candidates, search->words, 0);
+        while (pick--) {
+            bit = bitset_next(candidates, search->words, bit + 1);
+        }
+
+        weight *= candidate_count;
 
-    while (!cell_is_empty(&board->cells[*idx])) {
-        (*idx)++;
-        if (*idx == block_size * block_size) {
-            return FALSE;
+        if (!search_place(search, best, bit + 1) ||
+            !search_propagate(search, &best)) {
+            return 0;
         }
     }
 
-    return TRUE;
+    return weight;
 }
 
-int num_solutions(board_t* board) {
-    list_t stack;
+void num_solutions_estimate(board_t* board, long probes,
+                            solution_estimate_t* estimate) {
+    search_t search;
+    bitset_word_t* candidates;
 
-    int block_size = board_block_size(board);
+    double mean = 0;
+    double m2 = 0; /* Sum of squared deviations from the mean */
+    long i;
 
-    int count = 0;
-    int idx = 0;
+    search_init(&search, board);
+    search_begin(&search);
 
-    list_init(&stack);
+    if (search_resume(&search, 0, ESTIMATE_EXACT_NODES)) {
+        estimate->count = search.count;
+        estimate->low = search.count;
+        estimate->high = search.count;
+        estimate->probes = 0;
+        estimate->exact = TRUE;
 
-    if (advance_to_empty(board, &idx)) {
-        backtrack_state_push(&stack, idx);
-    } else {
-        return board_is_legal(board);
+        search_destroy(&search);
+        return;
     }
 
-    while (!list_is_empty(&stack)) {
-        backtrack_state_t* state = backtrack_state_top(&stack);
-        int value = state->value;
-
-        do {
-            value++;
-            if (value > block_size) {
-                break;
-            }
-
-            board->cells[state->idx].value = value;
-        } while (!board_is_legal(board));
-
-        state->value = value;
-
-        if (value > block_size) {
-            /* We've exhausted all possibilities for this cell - reset it
-             * and return to the previous one. */
-            board->cells[state->idx].value = 0;
-            backtrack_state_pop(&stack);
-        } else {
-            int next_idx = state->idx;
-
-            if (advance_to_empty(board, &next_idx)) {
-                /* We still have more empty cells to explore.  */
-                backtrack_state_push(&stack, next_idx);
-            } else {
-                /* We've finished the board - record our success! */
-                count++;
-            }
-        }
+    candidates = checked_calloc(search.words, sizeof(bitset_word_t));
+
+    /* Welford's algorithm keeps the running variance numerically stable. */
+    for (i = 0; i < probes; i++) {
+        double weight = probe(&search, candidates);
+        double delta = weight - mean;
+
+        mean += delta / (i + 1);
+        m2 += delta * (weight - mean);
     }
 
-    return count;
+    estimate->count = mean;
+    estimate->low = mean;
+    estimate->high = mean;
+    estimate->probes = probes;
+    estimate->exact = FALSE;
+
+    if (probes > 1) {
+        double error = ESTIMATE_Z * sqrt(m2 / (probes - 1) / probes);
+
+        estimate->low = mean > error ? mean - error : 0;
+        estimate->high = mean + error;
+    }
+
+    free(candidates);
+    search_destroy(&search);
 }
@@ -6,13 +6,87 @@
 #define BACKTRACK_H
 
 #include "board.h"
+#include "bool.h"
+#include "search.h"
 
 /**
- * Use exhaustive backtracking to find the number of solutions to `board`.
+ * Use exhaustive backtracking to find the number of solutions to `board`. The
+ * search branches on the cell with the fewest candidates and propagates naked
+ * and hidden singles at every step (see `search.h`).
  *
- * Note that the board's contents may be written to, but will be restored before
- * the function returns.
+ * Note that the board's contents are not modified.
  */
-int num_solutions(board_t* board);
+long num_solutions(board_t* board);
+
+/**
+ * Like `num_solutions`, but remember the counts of fully-explored subproblems
+ * in `tt` and reuse any found there from earlier counts (see
+ * `search_set_tt`). Successive counts of the same board as cells are filled
+ * in share most of their subproblems.
+ *
+ * Note that the board's contents are not modified.
+ */
+long num_solutions_cached(board_t* board, search_tt_t* tt);
+
+/**
+ * Count the solutions to `board`, stopping as soon as `limit` solutions have
+ * been found. The result is therefore `min(num_solutions(board), limit)`: a
+ * limit of 2 is enough to tell unsolvable, uniquely solvable and ambiguous
+ * boards apart. A `limit` of 0 means no limit.
+ *
+ * Note that the board's contents are not modified.
+ */
+long num_solutions_limit(board_t* board, int limit);
+
+/**
+ * Engines available for counting solutions.
+ */
+typedef enum count_engine {
+    CE_SEARCH, /* Bitmask search with propagation (see `search.h`) */
+    CE_DLX     /* Dancing links exact cover (see `dlx.h`) */
+} count_engine_t;
+
+/**
+ * Find the number of solutions to `board` using the specified engine. All
+ * engines return identical counts.
+ *
+ * Note that the board's contents are not modified.
+ */
+long num_solutions_engine(board_t* board, count_engine_t engine);
+
+/**
+ * Number of values `num_solutions_estimate` may try counting a board exactly
+ * before falling back to random probing.
+ */
+#define ESTIMATE_EXACT_NODES 100000L
+
+/**
+ * An estimated solution count.
+ */
+typedef struct solution_estimate {
+    double count; /* Estimated number of solutions */
+    double low;   /* Lower bound of the 95% confidence interval */
+    double high;  /* Upper bound of the 95% confidence interval */
+    long probes;  /* Number of random probes taken */
+    bool_t exact; /* Whether the board was small enough to count exactly */
+} solution_estimate_t;
+
+/**
+ * Estimate the number of solutions to `board` into `*estimate`.
+ *
+ * Boards whose search tree is explored within `ESTIMATE_EXACT_NODES` values
+ * are counted exactly, with a confidence interval of zero width. Otherwise,
+ * `probes` random paths are followed from the root of the `num_solutions`
+ * search tree (Knuth's estimator): every path picks uniformly among the
+ * candidates of each branching cell, and the product of the candidate counts
+ * along a path ending in a solution (or 0 for a dead end) is an unbiased
+ * estimate of the count. The mean of these is reported, together with a
+ * normal-approximation confidence interval.
+ *
+ * Probes draw from `rand`, so seed it for reproducible estimates. Note that
+ * the board's contents are not modified.
+ */
+void num_solutions_estimate(board_t* board, long probes,
+                            solution_estimate_t* estimate);
 
 #endif
@@ -0,0 +1,479 @@
+#include "bandcount.h"
+
+#include "checked_alloc.h"
+#include <stdlib.h>
+
+/**
+ * Number of completions of the remaining bands, keyed by the (possibly
+ * normalized) values used in every column before them.
+ */
+typedef struct band_memo {
+    int key_words;
+    int capacity; /* A power of 2 */
+    int size;
+    bitset_word_t* keys;
+    bignum_t* values;
+    bool_t* used;
+} band_memo_t;
+
+typedef struct band_ctx {
+    int m;
+    int n;
+    int block_size;
+    bitset_word_t full;
+
+    const int* givens; /* Fixed value of every cell in row-major order, or 0 */
+    bool_t* rest_empty; /* Whether bands from each index on have no givens */
+
+    /* Values that appear nowhere on the board, and those placed so far. */
+    bitset_word_t free_values;
+    bitset_word_t seen;
+
+    /* Values used in every column, and in the rows and blocks of each band. */
+    bitset_word_t* cols;
+    bitset_word_t* rows;
+    bitset_word_t* blocks;
+
+    band_memo_t* memos; /* One per band, caching completions from it on */
+
+    /* Scratch space for building keys. */
+    bitset_word_t* key;
+    bitset_word_t* sigs;
+    int* order;
+} band_ctx_t;
+
+static void memo_init(band_memo_t* memo, int key_words) {
+    memo->key_words = key_words;
+    memo->capacity = 64;
+    memo->size = 0;
+    memo->keys = checked_calloc(memo->capacity * key_words,
+                                sizeof(bitset_word_t));
+    memo->values = checked_calloc(memo->capacity, sizeof(bignum_t));
+    memo->used = checked_calloc(memo->capacity, sizeof(bool_t));
+}
+
+static void memo_destroy(band_memo_t* memo) {
+    int i;
+
+    for (i = 0; i < memo->capacity; i++) {
+        if (memo->used[i]) {
+            bignum_destroy(&memo->values[i]);
+        }
+    }
+
+    free(memo->used);
+    free(memo->values);
+    free(memo->keys);
+}
+
+static unsigned long hash_key(const bitset_word_t* key, int words) {
+    unsigned long hash = 0;
+    int i;
+
+    for (i = 0; i < words; i++) {
+        hash = (hash ^ key[i]) * 1000003UL;
+        hash ^= hash >> 15;
+    }
+
+    return hash;
+}
+
+static bool_t keys_equal(const bitset_word_t* a, const bitset_word_t* b,
+                         int words) {
+    int i;
+
+    for (i = 0; i < words; i++) {
+        if (a[i] != b[i]) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * Find the slot holding `key`, or the empty slot where it belongs.
+ */
+static int memo_slot(const band_memo_t* memo, const bitset_word_t* key) {
+    int slot = hash_key(key, memo->key_words) & (memo->capacity - 1);
+
+    while (memo->used[slot] &&
+           !keys_equal(&memo->keys[slot * memo->key_words], key,
+                       memo->key_words)) {
+        slot = (slot + 1) & (memo->capacity - 1);
+    }
+
+    return slot;
+}
+
+static void memo_grow(band_memo_t* memo) {
+    band_memo_t grown;
+    int i;
+
+    grown.key_words = memo->key_words;
+    grown.capacity = memo->capacity * 2;
+    grown.size = memo->size;
+    grown.keys = checked_calloc(grown.capacity * grown.key_words,
+                                sizeof(bitset_word_t));
+    grown.values = checked_calloc(grown.capacity, sizeof(bignum_t));
+    grown.used = checked_calloc(grown.capacity, sizeof(bool_t));
+
+    for (i = 0; i < memo->capacity; i++) {
+        const bitset_word_t* key = &memo->keys[i * memo->key_words];
+        int slot;
+        int j;
+
+        if (!memo->used[i]) {
+            continue;
+        }
+
+        slot = memo_slot(&grown, key);
+        for (j = 0; j < grown.key_words; j++) {
+            grown.keys[slot * grown.key_words + j] = key[j];
+        }
+        grown.values[slot] = memo->values[i];
+        grown.used[slot] = TRUE;
+    }
+
+    free(memo->used);
+    free(memo->values);
+    free(memo->keys);
+    *memo = grown;
+}
+
+/**
+ * Store `value` under `key`, which must not be present yet.
+ */
+static void memo_insert(band_memo_t* memo, const bitset_word_t* key,
+                        const bignum_t* value) {
+    int slot;
+    int j;
+
+    if (2 * (memo->size + 1) > memo->capacity) {
+        memo_grow(memo);
+    }
+
+    slot = memo_slot(memo, key);
+    for (j = 0; j < memo->key_words; j++) {
+        memo->keys[slot * memo->key_words + j] = key[j];
+    }
+    bignum_init(&memo->values[slot], 0);
+    bignum_assign(&memo->values[slot], value);
+    memo->used[slot] = TRUE;
+    memo->size++;
+}
+
+/**
+ * Check whether the `n`-word sequence `a` sorts after `b`.
+ */
+static bool_t words_greater(const bitset_word_t* a, const bitset_word_t* b,
+                            int n) {
+    int i;
+
+    for (i = 0; i < n; i++) {
+        if (a[i] != b[i]) {
+            return a[i] > b[i];
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * Sort the columns within each stack of `key`, and then the stacks themselves
+ * as sequences of columns.
+ */
+static void sort_columns(const band_ctx_t* ctx, bitset_word_t* key) {
+    int n = ctx->n;
+    int stack;
+    int i;
+    int j;
+    int k;
+
+    for (stack = 0; stack < ctx->m; stack++) {
+        bitset_word_t* cols = &key[stack * n];
+
+        for (i = 1; i < n; i++) {
+            bitset_word_t col = cols[i];
+
+            for (j = i; j > 0 && cols[j - 1] > col; j--) {
+                cols[j] = cols[j - 1];
+            }
+            cols[j] = col;
+        }
+    }
+
+    for (i = 1; i < ctx->m; i++) {
+        for (j = i; j > 0 && words_greater(&key[(j - 1) * n], &key[j * n], n);
+             j--) {
+            for (k = 0; k < n; k++) {
+                bitset_word_t tmp = key[(j - 1) * n + k];
+                key[(j - 1) * n + k] = key[j * n + k];
+                key[j * n + k] = tmp;
+            }
+        }
+    }
+}
+
+/**
+ * Map the column sets in `key` to an equivalent form, with the same number of
+ * completions when no later band has fixed values. Columns are sorted as in
+ * `sort_columns`, and values are then relabeled in order of the set of columns
+ * they appear in before sorting the columns again. Equivalent column sets
+ * usually, though not always, end up identical.
+ */
+static void normalize(band_ctx_t* ctx, bitset_word_t* key) {
+    int block_size = ctx->block_size;
+    int i;
+    int j;
+
+    sort_columns(ctx, key);
+
+    /* Order values by the columns they appear in, breaking ties by value. */
+    for (i = 0; i < block_size; i++) {
+        bitset_word_t sig = 0;
+
+        for (j = 0; j < block_size; j++) {
+            if (key[j] & ((bitset_word_t)1 << i)) {
+                sig |= (bitset_word_t)1 << j;
+            }
+        }
+        ctx->sigs[i] = sig;
+        ctx->order[i] = i;
+    }
+
+    for (i = 1; i < block_size; i++) {
+        int value = ctx->order[i];
+
+        for (j = i; j > 0 && ctx->sigs[ctx->order[j - 1]] > ctx->sigs[value];
+             j--) {
+            ctx->order[j] = ctx->order[j - 1];
+        }
+        ctx->order[j] = value;
+    }
+
+    for (j = 0; j < block_size; j++) {
+        bitset_word_t relabeled = 0;
+
+        for (i = 0; i < block_size; i++) {
+            if (key[j] & ((bitset_word_t)1 << ctx->order[i])) {
+                relabeled |= (bitset_word_t)1 << i;
+            }
+        }
+        key[j] = relabeled;
+    }
+
+    sort_columns(ctx, key);
+}
+
+static void count_from(band_ctx_t* ctx, int band, bignum_t* result);
+
+/**
+ * Fill the cells of `band` from its `idx`-th on in every possible way, adding
+ * the completions of each filling to `result`. Recursion depth is bounded by
+ * the number of cells in a band.
+ */
+static void fill(band_ctx_t* ctx, int band, int idx, bignum_t* result) {
+    int local_row = idx / ctx->block_size;
+    int col = idx % ctx->block_size;
+    int row = band * ctx->m + local_row;
+
+    bitset_word_t* row_mask;
+    bitset_word_t* block_mask;
+    bitset_word_t* col_mask;
+    bitset_word_t cand;
+    bitset_word_t unseen;
+    bitset_word_t seen;
+
+    if (idx == ctx->m * ctx->block_size) {
+        count_from(ctx, band + 1, result);
+        return;
+    }
+
+    /* Fixed values are already accounted for in the masks. */
+    if (ctx->givens[row * ctx->block_size + col]) {
+        fill(ctx, band, idx + 1, result);
+        return;
+    }
+
+    row_mask = &ctx->rows[row];
+    block_mask = &ctx->blocks[band * ctx->m + col / ctx->n];
+    col_mask = &ctx->cols[col];
+    cand = ctx->full & ~(*row_mask | *block_mask | *col_mask);
+
+    /* Only the first unseen free value may appear next. */
+    seen = ctx->seen;
+    unseen = ctx->free_values & ~seen;
+    cand &= ~unseen | (unseen & (~unseen + 1));
+
+    while (cand) {
+        bitset_word_t bit = cand & (~cand + 1);
+        cand &= cand - 1;
+
+        *row_mask |= bit;
+        *block_mask |= bit;
+        *col_mask |= bit;
+        ctx->seen = seen | (bit & ctx->free_values);
+
+        fill(ctx, band, idx + 1, result);
+
+        *row_mask &= ~bit;
+        *block_mask &= ~bit;
+        *col_mask &= ~bit;
+    }
+
+    ctx->seen = seen;
+}
+
+/**
+ * Add the number of ways to complete bands `band` onwards, given the values
+ * currently used in every column, to `result`.
+ */
+static void count_from(band_ctx_t* ctx, int band, bignum_t* result) {
+    band_memo_t* memo;
+    bignum_t completions;
+    int slot;
+    int i;
+
+    if (band == ctx->n) {
+        bignum_t one;
+
+        bignum_init(&one, 1);
+        bignum_add(result, &one);
+        bignum_destroy(&one);
+        return;
+    }
+
+    memo = &ctx->memos[band];
+    for (i = 0; i < ctx->block_size; i++) {
+        ctx->key[i] = ctx->cols[i];
+    }
+    if (ctx->rest_empty[band]) {
+        normalize(ctx, ctx->key);
+    }
+
+    slot = memo_slot(memo, ctx->key);
+    if (memo->used[slot]) {
+        bignum_add(result, &memo->values[slot]);
+        return;
+    }
+
+    bignum_init(&completions, 0);
+    fill(ctx, band, 0, &completions);
+
+    /* `fill` clobbers the scratch key. */
+    for (i = 0; i < ctx->block_size; i++) {
+        ctx->key[i] = ctx->cols[i];
+    }
+    if (ctx->rest_empty[band]) {
+        normalize(ctx, ctx->key);
+    }
+
+    memo_insert(memo, ctx->key, &completions);
+    bignum_add(result, &completions);
+    bignum_destroy(&completions);
+}
+
+bool_t band_count(const board_t* board, bignum_t* count) {
+    band_ctx_t ctx;
+    bignum_t result;
+    int* givens;
+    bitset_word_t used = 0;
+    int free_count = 0;
+    int row;
+    int col;
+    int i;
+
+    ctx.m = board->m;
+    ctx.n = board->n;
+    ctx.block_size = board_block_size(board);
+
+    if (ctx.block_size > BAND_COUNT_MAX_BLOCK_SIZE) {
+        return FALSE;
+    }
+
+    bignum_init(&result, 0);
+
+    if (board_has_conflicts(board)) {
+        bignum_assign(count, &result);
+        bignum_destroy(&result);
+        return TRUE;
+    }
+
+    ctx.full = ctx.block_size == BITSET_WORD_BITS
+                   ? ~(bitset_word_t)0
+                   : ((bitset_word_t)1 << ctx.block_size) - 1;
+
+    givens = checked_calloc(ctx.block_size * ctx.block_size, sizeof(int));
+    ctx.rest_empty = checked_calloc(ctx.n + 1, sizeof(bool_t));
+    ctx.cols = checked_calloc(ctx.block_size, sizeof(bitset_word_t));
+    ctx.rows = checked_calloc(ctx.block_size, sizeof(bitset_word_t));
+    ctx.blocks = checked_calloc(ctx.block_size, sizeof(bitset_word_t));
+    ctx.key = checked_calloc(ctx.block_size, sizeof(bitset_word_t));
+    ctx.sigs = checked_calloc(ctx.block_size, sizeof(bitset_word_t));
+    ctx.order = checked_calloc(ctx.block_size, sizeof(int));
+    ctx.memos = checked_calloc(ctx.n, sizeof(band_memo_t));
+
+    for (i = 0; i <= ctx.n; i++) {
+        ctx.rest_empty[i] = TRUE;
+    }
+
+    /* Fixed values are placed in the masks up front. */
+    for (row = 0; row < ctx.block_size; row++) {
+        for (col = 0; col < ctx.block_size; col++) {
+            int value = board_get_value(board, row, col);
+            int band = row / ctx.m;
+            bitset_word_t bit;
+
+            if (!value) {
+                continue;
+            }
+
+            bit = (bitset_word_t)1 << (value - 1);
+            givens[row * ctx.block_size + col] = value;
+            ctx.cols[col] |= bit;
+            ctx.rows[row] |= bit;
+            ctx.blocks[band * ctx.m + col / ctx.n] |= bit;
+            used |= bit;
+
+            for (i = 0; i <= band; i++) {
+                ctx.rest_empty[i] = FALSE;
+            }
+        }
+    }
+
+    ctx.givens = givens;
+    ctx.free_values = ctx.full & ~used;
+    ctx.seen = 0;
+
+    for (i = 0; i < ctx.n; i++) {
+        memo_init(&ctx.memos[i], ctx.block_size);
+    }
+
+    count_from(&ctx, 0, &result);
+
+    for (i = 0; i < ctx.block_size; i++) {
+        if (ctx.free_values & ((bitset_word_t)1 << i)) {
+            free_count++;
+            bignum_mul_small(&result, free_count);
+        }
+    }
+
+    bignum_assign(count, &result);
+
+    for (i = 0; i < ctx.n; i++) {
+        memo_destroy(&ctx.memos[i]);
+    }
+    free(ctx.memos);
+    free(ctx.order);
+    free(ctx.sigs);
+    free(ctx.key);
+    free(ctx.blocks);
+    free(ctx.rows);
+    free(ctx.cols);
+    free(ctx.rest_empty);
+    free(givens);
+    bignum_destroy(&result);
+
+    return TRUE;
+}
@@ -0,0 +1,46 @@
+/**
+ * bandcount.h - Band-by-band solution counting for sparse boards.
+ */
+
+#ifndef BANDCOUNT_H
+#define BANDCOUNT_H
+
+#include "bignum.h"
+#include "bitset.h"
+#include "board.h"
+#include "bool.h"
+
+/**
+ * Largest block size supported by `band_count`, which keeps the values used in
+ * every row, column and block in a single bitset word.
+ */
+#define BAND_COUNT_MAX_BLOCK_SIZE BITSET_WORD_BITS
+
+/**
+ * Count the solutions of `board` exactly into `count`, which must already be
+ * initialized. Returns false (leaving `count` untouched) if the block size
+ * exceeds `BAND_COUNT_MAX_BLOCK_SIZE`.
+ *
+ * The board is filled a band (a row of blocks) at a time. Once a band is
+ * filled, the later bands only depend on the values used in each column, so
+ * the number of ways to complete them is cached by those column sets. Where the
+ * later bands have no fixed values, column sets are first normalized under
+ * permutations of the columns within a stack, of the stacks themselves and of
+ * the values, none of which change the number of completions. Values
+ * that appear nowhere on the board are interchangeable: only solutions in
+ * which they first appear in increasing order are enumerated, and the result
+ * is multiplied by the number of their relabelings.
+ *
+ * The normalization is not a complete canonical form, and the cells of each
+ * band are still enumerated one at a time. This is practical for boards with
+ * givens and for small empty geometries, but not for an empty 9x9 board (or
+ * any 9x9 board whose first two bands are empty), which is unsupported: its
+ * first band normalizes to about 3200 distinct column sets, and each one takes
+ * about a minute to complete. Counting it would need the first band reduced to
+ * its few dozen equivalence classes and the last two bands counted by column
+ * sets rather than cell by cell, as Felgenhauer and Jarvis do; neither is
+ * implemented.
+ */
+bool_t band_count(const board_t* board, bignum_t* count);
+
+#endif
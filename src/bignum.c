@@ -0,0 +1,120 @@
+#include "bignum.h"
+
+#include "checked_alloc.h"
+#include <limits.h>
+#include <stdlib.h>
+
+static void reserve(bignum_t* num, int capacity) {
+    if (capacity > num->capacity) {
+        num->capacity = capacity > 2 * num->capacity ? capacity
+                                                     : 2 * num->capacity;
+        num->limbs =
+            checked_realloc(num->limbs, num->capacity * sizeof(unsigned long));
+    }
+}
+
+void bignum_init(bignum_t* num, unsigned long value) {
+    num->limbs = NULL;
+    num->size = 0;
+    num->capacity = 0;
+
+    while (value) {
+        reserve(num, num->size + 1);
+        num->limbs[num->size++] = value % BIGNUM_BASE;
+        value /= BIGNUM_BASE;
+    }
+}
+
+void bignum_destroy(bignum_t* num) {
+    free(num->limbs);
+}
+
+void bignum_assign(bignum_t* dest, const bignum_t* src) {
+    int i;
+
+    reserve(dest, src->size);
+    for (i = 0; i < src->size; i++) {
+        dest->limbs[i] = src->limbs[i];
+    }
+    dest->size = src->size;
+}
+
+void bignum_add(bignum_t* dest, const bignum_t* src) {
+    unsigned long carry = 0;
+    int size = dest->size > src->size ? dest->size : src->size;
+    int i;
+
+    reserve(dest, size + 1);
+
+    for (i = 0; i < size || carry; i++) {
+        unsigned long sum = carry;
+
+        if (i < dest->size) {
+            sum += dest->limbs[i];
+        }
+        if (i < src->size) {
+            sum += src->limbs[i];
+        }
+
+        dest->limbs[i] = sum % BIGNUM_BASE;
+        carry = sum / BIGNUM_BASE;
+    }
+
+    dest->size = i;
+}
+
+void bignum_mul_small(bignum_t* dest, unsigned long factor) {
+    unsigned long carry = 0;
+    int i;
+
+    if (!factor) {
+        dest->size = 0;
+        return;
+    }
+
+    for (i = 0; i < dest->size; i++) {
+        unsigned long product = dest->limbs[i] * factor + carry;
+
+        dest->limbs[i] = product % BIGNUM_BASE;
+        carry = product / BIGNUM_BASE;
+    }
+
+    while (carry) {
+        reserve(dest, dest->size + 1);
+        dest->limbs[dest->size++] = carry % BIGNUM_BASE;
+        carry /= BIGNUM_BASE;
+    }
+}
+
+bool_t bignum_is_zero(const bignum_t* num) {
+    return num->size == 0;
+}
+
+bool_t bignum_to_ulong(const bignum_t* num, unsigned long* value) {
+    unsigned long result = 0;
+    int i;
+
+    for (i = num->size - 1; i >= 0; i--) {
+        if (result > (ULONG_MAX - num->limbs[i]) / BIGNUM_BASE) {
+            return FALSE;
+        }
+        result = result * BIGNUM_BASE + num->limbs[i];
+    }
+
+    *value = result;
+    return TRUE;
+}
+
+void bignum_print(const bignum_t* num, FILE* stream) {
+    int i;
+
+    if (!num->size) {
+        fputc('0', stream);
+        return;
+    }
+
+    fprintf(stream, "%lu", num->limbs[num->size - 1]);
+    for (i = num->size - 2; i >= 0; i--) {
+        fprintf(stream, "%0*lu", BIGNUM_BASE_DIGITS, num->limbs[i]);
+    }
+}
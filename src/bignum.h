@@ -0,0 +1,71 @@
+/**
+ * bignum.h - Arbitrary-precision unsigned integers for large solution counts.
+ */
+
+#ifndef BIGNUM_H
+#define BIGNUM_H
+
+#include "bool.h"
+#include <stdio.h>
+
+/**
+ * Numbers are stored as little-endian arrays of decimal limbs in this base,
+ * keeping limb products well within an `unsigned long`.
+ */
+#define BIGNUM_BASE 10000UL
+
+/**
+ * Number of decimal digits per limb.
+ */
+#define BIGNUM_BASE_DIGITS 4
+
+/**
+ * An arbitrary-precision unsigned integer.
+ */
+typedef struct bignum {
+    unsigned long* limbs; /* Least significant limb first */
+    int size;             /* Number of limbs in use (0 for zero) */
+    int capacity;
+} bignum_t;
+
+/**
+ * Initialize `num` to `value`.
+ */
+void bignum_init(bignum_t* num, unsigned long value);
+
+/**
+ * Destroy `num`, releasing any allocated resources.
+ */
+void bignum_destroy(bignum_t* num);
+
+/**
+ * Set `dest` to the value of `src`.
+ */
+void bignum_assign(bignum_t* dest, const bignum_t* src);
+
+/**
+ * Add `src` to `dest`.
+ */
+void bignum_add(bignum_t* dest, const bignum_t* src);
+
+/**
+ * Multiply `dest` by `factor`, which must not exceed `BIGNUM_BASE`.
+ */
+void bignum_mul_small(bignum_t* dest, unsigned long factor);
+
+/**
+ * Check whether `num` is zero.
+ */
+bool_t bignum_is_zero(const bignum_t* num);
+
+/**
+ * Store `num` in `*value`, returning false if it does not fit.
+ */
+bool_t bignum_to_ulong(const bignum_t* num, unsigned long* value);
+
+/**
+ * Print `num` in decimal to `stream`.
+ */
+void bignum_print(const bignum_t* num, FILE* stream);
+
+#endif
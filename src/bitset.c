@@ -0,0 +1,46 @@
+#include "bitset.h"
+
+int bitset_count(const bitset_word_t* set, int words) {
+    int count = 0;
+    int i;
+
+    for (i = 0; i < words; i++) {
+        count += __builtin_popcountl(set[i]);
+    }
+
+    return count;
+}
+
+int bitset_next(const bitset_word_t* set, int words, int bit) {
+    int word_idx = BITSET_WORD_IDX(bit);
+    bitset_word_t word;
+
+    if (word_idx >= words) {
+        return -1;
+    }
+
+    /* Mask out bits below `bit` in its own word. */
+    word = set[word_idx] & (~(bitset_word_t)0 << (bit % BITSET_WORD_BITS));
+
+    while (!word) {
+        if (++word_idx == words) {
+            return -1;
+        }
+        word = set[word_idx];
+    }
+
+    return word_idx * BITSET_WORD_BITS + __builtin_ctzl(word);
+}
+
+void bitset_fill(bitset_word_t* set, int bits) {
+    int words = BITSET_WORDS(bits);
+    int i;
+
+    for (i = 0; i < words; i++) {
+        set[i] = ~(bitset_word_t)0;
+    }
+
+    if (bits % BITSET_WORD_BITS) {
+        set[words - 1] = BITSET_WORD_MASK(bits) - 1;
+    }
+}
@@ -0,0 +1,48 @@
+/**
+ * bitset.h - Small fixed-size bitsets, used to track sets of cell values.
+ */
+
+#ifndef BITSET_H
+#define BITSET_H
+
+#include <limits.h>
+
+/**
+ * A single word of bitset storage. Bitsets are stored as arrays of these, with
+ * bit `i` living in word `i / BITSET_WORD_BITS`.
+ */
+typedef unsigned long bitset_word_t;
+
+#define BITSET_WORD_BITS ((int)(sizeof(bitset_word_t) * CHAR_BIT))
+
+/**
+ * Number of words required to store a bitset of `bits` bits.
+ */
+#define BITSET_WORDS(bits) (((bits) + BITSET_WORD_BITS - 1) / BITSET_WORD_BITS)
+
+#define BITSET_WORD_IDX(bit) ((bit) / BITSET_WORD_BITS)
+#define BITSET_WORD_MASK(bit) ((bitset_word_t)1 << ((bit) % BITSET_WORD_BITS))
+
+#define BITSET_TEST(set, bit)                                                  \
+    (((set)[BITSET_WORD_IDX(bit)] & BITSET_WORD_MASK(bit)) != 0)
+#define BITSET_SET(set, bit) ((set)[BITSET_WORD_IDX(bit)] |= BITSET_WORD_MASK(bit))
+#define BITSET_CLEAR(set, bit)                                                 \
+    ((set)[BITSET_WORD_IDX(bit)] &= ~BITSET_WORD_MASK(bit))
+
+/**
+ * Count the set bits in the `words`-word bitset `set`.
+ */
+int bitset_count(const bitset_word_t* set, int words);
+
+/**
+ * Find the first set bit in `set` at or after `bit`, returning -1 if there is
+ * none.
+ */
+int bitset_next(const bitset_word_t* set, int words, int bit);
+
+/**
+ * Set bits `[0, bits)` of `set`, clearing any remaining bits in its words.
+ */
+void bitset_fill(bitset_word_t* set, int bits);
+
+#endif
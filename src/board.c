@@ -2,35 +2,95 @@
 
 #include "bool.h"
 #include "checked_alloc.h"
+#include "hash.h"
+#include "legality.h"
+#include <limits.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-bool_t cell_is_empty(const cell_t* cell) { return cell->value == 0; }
-bool_t cell_is_fixed(const cell_t* cell) { return cell->flags == CF_FIXED; }
-bool_t cell_is_error(const cell_t* cell) { return cell->flags == CF_ERROR; }
-
 void board_init(board_t* board, int m, int n) {
+    board_init_layout(board, m, n, BL_ROW_MAJOR);
+}
+
+void board_init_layout(board_t* board, int m, int n, board_layout_t layout) {
     int block_size = m * n;
-    cell_t* cells = checked_calloc(block_size * block_size, sizeof(cell_t));
+    int unit_count = UK_COUNT * block_size;
+    int flag_words = BITSET_WORDS(block_size * block_size);
 
-    board->cells = cells;
     board->m = m;
     board->n = n;
+    board->geom = geometry_acquire(m, n, layout);
+    legality_init();
+
+    if (block_size <= UCHAR_MAX) {
+        board->values8 = checked_calloc(block_size * block_size, 1);
+        board->values16 = NULL;
+    } else {
+        board->values8 = NULL;
+        board->values16 =
+            checked_calloc(block_size * block_size, sizeof(unsigned short));
+    }
+    board->fixed = checked_calloc(flag_words, sizeof(bitset_word_t));
+    board->errors = checked_calloc(flag_words, sizeof(bitset_word_t));
+
+    board->mask_words = BITSET_WORDS(block_size);
+    board->unit_counts = checked_calloc(unit_count * block_size, sizeof(int));
+    board->unit_masks =
+        checked_calloc(unit_count * board->mask_words, sizeof(bitset_word_t));
+    board->conflicts = checked_calloc(block_size * block_size, sizeof(int));
+    board->empty_count = block_size * block_size;
+    board->conflict_count = 0;
+    board->hash = 0;
 }
 
-void board_destroy(board_t* board) { free(board->cells); }
+void board_destroy(board_t* board) {
+    free(board->conflicts);
+    free(board->unit_masks);
+    free(board->unit_counts);
+    free(board->errors);
+    free(board->fixed);
+    free(board->values16);
+    free(board->values8);
+    geometry_release(board->geom);
+}
 
 void board_clone(board_t* dest, const board_t* src) {
+    board_init_layout(dest, src->m, src->n, board_get_layout(src));
+    board_assign(dest, src);
+}
+
+void board_assign(board_t* dest, const board_t* src) {
     int block_size = board_block_size(src);
+    int unit_count = UK_COUNT * block_size;
+    int flag_words = BITSET_WORDS(block_size * block_size);
 
-    board_init(dest, src->m, src->n);
-    memcpy(dest->cells, src->cells, block_size * block_size * sizeof(cell_t));
+    if (src->values8) {
+        memcpy(dest->values8, src->values8, block_size * block_size);
+    } else {
+        memcpy(dest->values16, src->values16,
+               block_size * block_size * sizeof(unsigned short));
+    }
+    memcpy(dest->fixed, src->fixed, flag_words * sizeof(bitset_word_t));
+    memcpy(dest->errors, src->errors, flag_words * sizeof(bitset_word_t));
+    memcpy(dest->unit_counts, src->unit_counts,
+           unit_count * block_size * sizeof(int));
+    memcpy(dest->unit_masks, src->unit_masks,
+           unit_count * src->mask_words * sizeof(bitset_word_t));
+    memcpy(dest->conflicts, src->conflicts,
+           block_size * block_size * sizeof(int));
+    dest->empty_count = src->empty_count;
+    dest->conflict_count = src->conflict_count;
+    dest->hash = src->hash;
 }
 
 int board_block_size(const board_t* board) { return board->m * board->n; }
 
+board_layout_t board_get_layout(const board_t* board) {
+    return board->geom->layout;
+}
+
 int board_block_row(const board_t* board, int block_row, int local_row) {
     return block_row * board->m + local_row;
 }
@@ -39,29 +99,229 @@ int board_block_col(const board_t* board, int block_col, int local_col) {
     return block_col * board->n + local_col;
 }
 
-cell_t* board_access(board_t* board, int row, int col) {
-    return &board->cells[row * board_block_size(board) + col];
+int board_block_index(const board_t* board, int row, int col) {
+    return (row / board->m) * board->m + col / board->n;
 }
 
-const cell_t* board_access_const(const board_t* board, int row, int col) {
-    return board_access((board_t*)board, row, col);
+int board_cell_index(const board_t* board, int row, int col) {
+    return geometry_cell_index(board->geom, row, col);
 }
 
-/* LEGALITY CHECKS/ERROR MARKING */
+void board_cell_position(const board_t* board, int idx, int* row, int* col) {
+    const int* units = geometry_cell_units(board->geom, idx);
+    int block_size = board_block_size(board);
+
+    *row = units[UK_ROW] - UK_ROW * block_size;
+    *col = units[UK_COL] - UK_COL * block_size;
+}
+
+int board_get_value(const board_t* board, int row, int col) {
+    return board_get_value_at(board, board_cell_index(board, row, col));
+}
+
+int board_get_value_at(const board_t* board, int idx) {
+    return board->values8 ? board->values8[idx] : board->values16[idx];
+}
+
+cell_flags_t board_get_flags(const board_t* board, int row, int col) {
+    return board_get_flags_at(board, board_cell_index(board, row, col));
+}
+
+cell_flags_t board_get_flags_at(const board_t* board, int idx) {
+    if (BITSET_TEST(board->fixed, idx)) {
+        return CF_FIXED;
+    }
+    return BITSET_TEST(board->errors, idx) ? CF_ERROR : CF_NONE;
+}
+
+void board_set_flags(board_t* board, int row, int col, cell_flags_t flags) {
+    board_set_flags_at(board, board_cell_index(board, row, col), flags);
+}
+
+void board_set_flags_at(board_t* board, int idx, cell_flags_t flags) {
+    BITSET_CLEAR(board->fixed, idx);
+    BITSET_CLEAR(board->errors, idx);
+
+    if (flags == CF_FIXED) {
+        BITSET_SET(board->fixed, idx);
+    } else if (flags == CF_ERROR) {
+        BITSET_SET(board->errors, idx);
+    }
+}
+
+/* OCCUPANCY TRACKING */
+
+/**
+ * Record an occurrence of `value` being added to (`delta` = 1) or removed from
+ * (`delta` = -1) each of the units containing the cell at index `idx`.
+ */
+static void update_units(board_t* board, int idx, int value, int delta) {
+    int block_size = board_block_size(board);
+    const int* units = geometry_cell_units(board->geom, idx);
+    int kind;
+
+    for (kind = 0; kind < UK_COUNT; kind++) {
+        int* count = &board->unit_counts[units[kind] * block_size + value - 1];
+        bitset_word_t* mask =
+            &board->unit_masks[units[kind] * board->mask_words];
+
+        *count += delta;
+        if (*count) {
+            BITSET_SET(mask, value - 1);
+        } else {
+            BITSET_CLEAR(mask, value - 1);
+        }
+    }
+}
 
 /**
- * Abstraction for a function that can retrieve a cell based on two indices (a
- * "context" and a "local offset", both in the range `[0, block_size)`), used in
- * the generalized legality algorithm to abstract row, column and block checks.
+ * Update the error flag of the specified cell based on its conflict count.
+ * Fixed cells are never marked as errors.
  */
-typedef cell_t* (*cell_retriever_t)(board_t* board, int ctx, int local_off);
+static void refresh_error_flag(board_t* board, int idx) {
+    if (BITSET_TEST(board->fixed, idx)) {
+        return;
+    }
+
+    if (board->conflicts[idx]) {
+        BITSET_SET(board->errors, idx);
+    } else {
+        BITSET_CLEAR(board->errors, idx);
+    }
+}
 
 /**
- * Callback type invoked when two conflicting cells are found. If the callback
- * returns false, processing is halted and the legality check returns false as
- * well.
+ * If the neighbor at index `peer` holds `value`, add `delta` to the conflict
+ * counts of both it and the cell at index `idx`.
  */
-typedef bool_t (*cell_conflict_handler_t)(cell_t* a, cell_t* b);
+static void update_peer_conflict(board_t* board, int idx, int peer, int value,
+                                 int delta) {
+    if (board_get_value_at(board, peer) == value) {
+        board->conflicts[peer] += delta;
+        board->conflicts[idx] += delta;
+        board->conflict_count += delta;
+        refresh_error_flag(board, peer);
+    }
+}
+
+/**
+ * Add `delta` to the conflict counts of the cell at index `idx` and of each of
+ * its neighbors holding `value`. Every neighbor is visited exactly once, even
+ * if it shares both a row (or column) and a block with the cell.
+ */
+static void update_conflicts(board_t* board, int idx, int value, int delta) {
+    const geometry_t* geom = board->geom;
+    int i;
+
+    if (geom->peers) {
+        const int* peers = &geom->peers[idx * geom->peer_count];
+
+        for (i = 0; i < geom->peer_count; i++) {
+            update_peer_conflict(board, idx, peers[i], value, delta);
+        }
+    } else {
+        const int* units = geometry_cell_units(geom, idx);
+        const int* block = geometry_unit(geom, units[UK_BLOCK]);
+
+        int kind;
+
+        for (kind = UK_ROW; kind <= UK_COL; kind++) {
+            const int* unit = geometry_unit(geom, units[kind]);
+
+            for (i = 0; i < geom->block_size; i++) {
+                if (unit[i] != idx) {
+                    update_peer_conflict(board, idx, unit[i], value, delta);
+                }
+            }
+        }
+
+        for (i = 0; i < geom->block_size; i++) {
+            const int* peer_units = geometry_cell_units(geom, block[i]);
+
+            if (peer_units[UK_ROW] != units[UK_ROW] &&
+                peer_units[UK_COL] != units[UK_COL]) {
+                update_peer_conflict(board, idx, block[i], value, delta);
+            }
+        }
+    }
+
+    refresh_error_flag(board, idx);
+}
+
+void board_set_value_at(board_t* board, int idx, int value) {
+    int old_value = board_get_value_at(board, idx);
+
+    if (old_value == value) {
+        return;
+    }
+
+    if (!old_value) {
+        board->empty_count--;
+    } else {
+        update_units(board, idx, old_value, -1);
+        update_conflicts(board, idx, old_value, -1);
+        board->hash ^= board_zobrist_key(idx, old_value);
+    }
+
+    if (board->values8) {
+        board->values8[idx] = (unsigned char)value;
+    } else {
+        board->values16[idx] = (unsigned short)value;
+    }
+
+    if (!value) {
+        board->empty_count++;
+    } else {
+        update_units(board, idx, value, 1);
+        update_conflicts(board, idx, value, 1);
+        board->hash ^= board_zobrist_key(idx, value);
+    }
+}
+
+void board_set_value(board_t* board, int row, int col, int value) {
+    board_set_value_at(board, board_cell_index(board, row, col), value);
+}
+
+board_hash_t board_zobrist_key(int idx, int value) {
+    /* Keys are derived from the cell and value with the SplitMix64 finalizer
+     * rather than stored, so no table needs to be set up or shared. */
+    board_hash_t x = (board_hash_t)idx * 65537UL + (board_hash_t)value;
+
+    return hash_mix(x + HASH_GOLDEN_GAMMA);
+}
+
+board_hash_t board_hash(const board_t* board) { return board->hash; }
+
+bool_t board_is_legal_placement(const board_t* board, int row, int col,
+                                int value) {
+    return board_is_legal_placement_at(
+        board, board_cell_index(board, row, col), value);
+}
+
+bool_t board_is_legal_placement_at(const board_t* board, int idx, int value) {
+    int block_size = board_block_size(board);
+    int own = board_get_value_at(board, idx) == value;
+
+    const int* units = geometry_cell_units(board->geom, idx);
+    int kind;
+
+    for (kind = 0; kind < UK_COUNT; kind++) {
+        if (board->unit_counts[units[kind] * block_size + value - 1] > own) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/* LEGALITY CHECKS/ERROR MARKING */
+
+/**
+ * Callback type invoked when two conflicting cells (given by index) are found.
+ * If the callback returns false, processing is halted and the legality check
+ * returns false as well.
+ */
+typedef bool_t (*cell_conflict_handler_t)(board_t* board, int a, int b);
 
 /**
  * Value map item, used to track the last cell on the board in which a given
@@ -74,36 +334,34 @@ typedef struct {
 } val_map_item_t;
 
 /**
- * Check that each of the non-empty cells retrieved by `retriever` has a
- * distinct value, invoking `handler` on conflicting cells.
+ * Check that each of the non-empty cells in the specified (global) unit has a
+ * distinct value, invoking `handler` on conflicting cells. Values are read from
+ * the board's packed value array.
  *
  * If `handler` returns false for a given pair of cells, no further checks are
  * performed and the function returns false. Otherwise, true is returned.
  *
- * `ctx` is held constant while `local_off` is iterated across
- * `[0, block_size)`.
- *
  * `map` is used as scratch storage during the check, and must contain at least
  * `block_size` items.
  */
-static bool_t check_legal(board_t* board, val_map_item_t* map, int ctx,
-                          cell_retriever_t retrieve,
+static bool_t check_legal(board_t* board, val_map_item_t* map, int unit_idx,
                           cell_conflict_handler_t handler) {
     int block_size = board_block_size(board);
+    const int* unit = geometry_unit(board->geom, unit_idx);
     int local_off;
 
     memset(map, 0, block_size * sizeof(val_map_item_t));
 
     for (local_off = 0; local_off < block_size; local_off++) {
-        cell_t* cell = retrieve(board, ctx, local_off);
+        int idx = unit[local_off];
+        int value = board_get_value_at(board, idx);
 
-        if (!cell_is_empty(cell)) {
-            val_map_item_t* item = map + (cell->value - 1);
+        if (value) {
+            val_map_item_t* item = map + (value - 1);
 
             if (item->occupied) {
                 /* We've seen this value before - report the conflict. */
-                cell_t* old_cell = retrieve(board, ctx, item->local_off);
-                if (!handler(old_cell, cell)) {
+                if (!handler(board, unit[item->local_off], idx)) {
                     return FALSE;
                 }
             }
@@ -117,102 +375,53 @@ static bool_t check_legal(board_t* board, val_map_item_t* map, int ctx,
 }
 
 /**
- * Retriever for checking legality in a row - use `local_off` to index into the
- * row designated by `ctx`.
- */
-static cell_t* retrieve_by_row(board_t* board, int ctx, int local_off) {
-    return board_access(board, ctx, local_off);
-}
-
-/**
- * Retriever for checking legality in a column - use `local_off` to index into
- * the column designated by `ctx`.
+ * Find duplicated values in every unit of `board` using the fastest available
+ * legality kernel, storing them to `dups` as described in
+ * `legality_find_duplicates`. `onehot` is scratch space with a word for every
+ * cell. The board's block size must not exceed `LEGALITY_MAX_BLOCK_SIZE`.
+ * Returns true if any duplicates were found.
  */
-static cell_t* retrieve_by_col(board_t* board, int ctx, int local_off) {
-    return board_access(board, local_off, ctx);
-}
-
-/**
- * Retriever for checking legality in a block - use `local_off` to index into
- * the block designated by `ctx` (in row-major order).
- */
-static cell_t* retrieve_by_block(board_t* board, int ctx, int local_off) {
-    int block_row = ctx / board->m;
-    int block_col = ctx % board->m;
-
-    int local_row = local_off / board->n;
-    int local_col = local_off % board->n;
-
-    return board_access(board, board_block_row(board, block_row, local_row),
-                        board_block_col(board, block_col, local_col));
-}
+static bool_t find_duplicates(const board_t* board, bitset_word_t* onehot,
+                              bitset_word_t* dups) {
+    int cell_count = board->geom->cell_count;
+    int idx;
+
+    for (idx = 0; idx < cell_count; idx++) {
+        int value = board_get_value_at(board, idx);
+        onehot[idx] = value ? BITSET_WORD_MASK(value - 1) : 0;
+    }
 
-/**
- * Conflict handler that aborts further checking of the board.
- */
-static bool_t abort_check_handler(cell_t* a, cell_t* b) {
-    (void)a;
-    (void)b;
-    return FALSE;
+    return legality_find_duplicates(board->geom, onehot, dups,
+                                    legality_best_kernel());
 }
 
 bool_t board_is_legal(const board_t* board) {
-    board_t* nonconst_board = (board_t*)board;
-
-    int block_size = board_block_size(board);
-    val_map_item_t* map = checked_calloc(block_size, sizeof(val_map_item_t));
-
-    int i;
-    bool_t ret = TRUE;
-
-    for (i = 0; i < block_size; i++) {
-        ret = check_legal(nonconst_board, map, i, retrieve_by_row,
-                          abort_check_handler);
-        if (!ret) {
-            break;
-        }
+    return board->conflict_count == 0;
+}
 
-        ret = check_legal(nonconst_board, map, i, retrieve_by_col,
-                          abort_check_handler);
-        if (!ret) {
-            break;
-        }
+bool_t board_is_full(const board_t* board) { return !board->empty_count; }
 
-        ret = check_legal(nonconst_board, map, i, retrieve_by_block,
-                          abort_check_handler);
-        if (!ret) {
-            break;
-        }
-    }
+bool_t board_has_conflicts(const board_t* board) {
+    return board->conflict_count > 0;
+}
 
-    free(map);
-    return ret;
+bool_t board_is_solved(const board_t* board) {
+    return board_is_full(board) && !board_has_conflicts(board);
 }
 
 /* ERROR MARKING */
 
 static void clear_errors(board_t* board) {
-    int block_size = board_block_size(board);
-
-    int row;
-    int col;
-
-    for (row = 0; row < block_size; row++) {
-        for (col = 0; col < block_size; col++) {
-            cell_t* cell = board_access(board, row, col);
-            if (cell_is_error(cell)) {
-                cell->flags = CF_NONE;
-            }
-        }
-    }
+    memset(board->errors, 0,
+           BITSET_WORDS(board->geom->cell_count) * sizeof(bitset_word_t));
 }
 
 /**
- * Mark `cell` as an error if it is not fixed.
+ * Mark the cell at index `idx` as an error if it is not fixed.
  */
-static void cell_mark_error(cell_t* cell) {
-    if (!cell_is_fixed(cell)) {
-        cell->flags = CF_ERROR;
+static void cell_mark_error(board_t* board, int idx) {
+    if (!BITSET_TEST(board->fixed, idx)) {
+        BITSET_SET(board->errors, idx);
     }
 }
 
@@ -220,24 +429,54 @@ static void cell_mark_error(cell_t* cell) {
  * Conflict handler that marks offending cells as errors and continues
  * processing.
  */
-static bool_t mark_errors_handler(cell_t* a, cell_t* b) {
-    cell_mark_error(a);
-    cell_mark_error(b);
+static bool_t mark_errors_handler(board_t* board, int a, int b) {
+    cell_mark_error(board, a);
+    cell_mark_error(board, b);
     return TRUE;
 }
 
+/**
+ * Mark the cells holding values in `dups` (as computed by `find_duplicates`)
+ * within any of their units as errors.
+ */
+static void mark_duplicates(board_t* board, const bitset_word_t* dups) {
+    int idx;
+
+    for (idx = 0; idx < board->geom->cell_count; idx++) {
+        const int* units = geometry_cell_units(board->geom, idx);
+        int value = board_get_value_at(board, idx);
+
+        bitset_word_t unit_dups =
+            dups[units[UK_ROW]] | dups[units[UK_COL]] | dups[units[UK_BLOCK]];
+
+        if (value && (unit_dups & BITSET_WORD_MASK(value - 1))) {
+            cell_mark_error(board, idx);
+        }
+    }
+}
+
 void board_mark_errors(board_t* board) {
     int block_size = board_block_size(board);
-    val_map_item_t* map = checked_calloc(block_size, sizeof(val_map_item_t));
+    val_map_item_t* map;
 
     int i;
 
     clear_errors(board);
 
-    for (i = 0; i < block_size; i++) {
-        check_legal(board, map, i, retrieve_by_row, mark_errors_handler);
-        check_legal(board, map, i, retrieve_by_col, mark_errors_handler);
-        check_legal(board, map, i, retrieve_by_block, mark_errors_handler);
+    if (block_size <= LEGALITY_MAX_BLOCK_SIZE) {
+        bitset_word_t onehot[LEGALITY_MAX_BLOCK_SIZE * LEGALITY_MAX_BLOCK_SIZE];
+        bitset_word_t dups[UK_COUNT * LEGALITY_MAX_BLOCK_SIZE];
+
+        if (find_duplicates(board, onehot, dups)) {
+            mark_duplicates(board, dups);
+        }
+        return;
+    }
+
+    map = checked_calloc(block_size, sizeof(val_map_item_t));
+
+    for (i = 0; i < UK_COUNT * block_size; i++) {
+        check_legal(board, map, i, mark_errors_handler);
     }
 
     free(map);
@@ -246,51 +485,114 @@ void board_mark_errors(board_t* board) {
 /* CANDIDATES */
 
 int board_gather_candidates(board_t* board, int row, int col, int* candidates) {
-    cell_t* cell = board_access(board, row, col);
-
     int block_size = board_block_size(board);
     int candidate_count = 0;
 
     int val;
+
+    board_set_value(board, row, col, 0);
+
+    /* No value can make an already-conflicting board legal. */
+    if (board_has_conflicts(board)) {
+        return 0;
+    }
+
     for (val = 1; val <= block_size; val++) {
-        cell->value = val;
-        if (board_is_legal(board)) {
+        if (board_is_legal_placement(board, row, col, val)) {
             candidates[candidate_count++] = val;
         }
     }
 
-    cell->value = 0;
-
     return candidate_count;
 }
 
 bool_t board_get_single_candidate(board_t* board, int row, int col,
                                   int* candidate) {
-    bool_t ret = FALSE;
-
     int block_size = board_block_size(board);
-    cell_t* cell = board_access(board, row, col);
-
     int last_candidate = 0;
 
     int val;
+
+    board_set_value(board, row, col, 0);
+
+    if (board_has_conflicts(board)) {
+        return FALSE;
+    }
+
     for (val = 1; val <= block_size; val++) {
-        cell->value = val;
-        if (board_is_legal(board)) {
+        if (board_is_legal_placement(board, row, col, val)) {
             if (last_candidate) {
-                goto cleanup;
-            } else {
-                last_candidate = val;
+                return FALSE;
             }
+            last_candidate = val;
         }
     }
 
-    ret = TRUE;
     *candidate = last_candidate;
+    return last_candidate != 0;
+}
+
+void board_compute_all_candidates(const board_t* board,
+                                  board_candidates_t* candidates) {
+    int block_size = board_block_size(board);
+    int words = board->mask_words;
+
+    bitset_word_t* full = checked_calloc(words, sizeof(bitset_word_t));
+    int idx;
+
+    candidates->geom = geometry_acquire(board->m, board->n,
+                                        board_get_layout(board));
+    candidates->words = words;
+    candidates->sets =
+        checked_calloc(block_size * block_size * words, sizeof(bitset_word_t));
+
+    if (board_has_conflicts(board)) {
+        goto cleanup;
+    }
+
+    bitset_fill(full, block_size);
+
+    for (idx = 0; idx < block_size * block_size; idx++) {
+        bitset_word_t* set = &candidates->sets[idx * words];
+        const int* units = geometry_cell_units(board->geom, idx);
+
+        const bitset_word_t* row_mask =
+            &board->unit_masks[units[UK_ROW] * words];
+        const bitset_word_t* col_mask =
+            &board->unit_masks[units[UK_COL] * words];
+        const bitset_word_t* block_mask =
+            &board->unit_masks[units[UK_BLOCK] * words];
+
+        int i;
+
+        if (board_get_value_at(board, idx)) {
+            continue;
+        }
+
+        for (i = 0; i < words; i++) {
+            set[i] = full[i] & ~(row_mask[i] | col_mask[i] | block_mask[i]);
+        }
+    }
 
 cleanup:
-    cell->value = 0;
-    return ret;
+    free(full);
+}
+
+void board_candidates_destroy(board_candidates_t* candidates) {
+    free(candidates->sets);
+    geometry_release(candidates->geom);
+}
+
+const bitset_word_t*
+board_candidates_access(const board_candidates_t* candidates, int row,
+                        int col) {
+    return board_candidates_access_at(
+        candidates, geometry_cell_index(candidates->geom, row, col));
+}
+
+const bitset_word_t*
+board_candidates_access_at(const board_candidates_t* candidates, int idx) {
+    return &candidates->sets[idx * candidates->words];
 }
 
 /* PRINTING */
@@ -304,15 +606,19 @@ static void print_separator_line(int m, int n, FILE* stream) {
     fputc('\n', stream);
 }
 
-static void print_cell(const cell_t* cell, FILE* stream, bool_t mark_errors) {
+static void print_cell(const board_t* board, int row, int col, FILE* stream,
+                       bool_t mark_errors) {
+    int value = board_get_value(board, row, col);
+    cell_flags_t flags = board_get_flags(board, row, col);
+
     fputc(' ', stream);
-    if (cell_is_empty(cell)) {
+    if (!value) {
         fprintf(stream, "   ");
     } else {
-        char decorator = cell_is_fixed(cell)
+        char decorator = flags == CF_FIXED
                              ? '.'
-                             : mark_errors && cell_is_error(cell) ? '*' : ' ';
-        fprintf(stream, "%2d%c", cell->value, decorator);
+                             : mark_errors && flags == CF_ERROR ? '*' : ' ';
+        fprintf(stream, "%2d%c", value, decorator);
     }
 }
 
@@ -330,8 +636,7 @@ void board_print(const board_t* board, FILE* stream, bool_t mark_errors) {
             if (col % board->n == 0) {
                 fputc('|', stream);
             }
-            print_cell(board_access_const(board, row, col), stream,
-                       mark_errors);
+            print_cell(board, row, col, stream, mark_errors);
         }
 
         fputs("|\n", stream);
@@ -342,9 +647,10 @@ void board_print(const board_t* board, FILE* stream, bool_t mark_errors) {
 
 /* SERIALIZATION/DESERIALIZATION */
 
-static void serialize_cell(const cell_t* cell, FILE* stream) {
-    fprintf(stream, "%d", cell->value);
-    if (cell_is_fixed(cell)) {
+static void serialize_cell(const board_t* board, int row, int col,
+                           FILE* stream) {
+    fprintf(stream, "%d", board_get_value(board, row, col));
+    if (board_get_flags(board, row, col) == CF_FIXED) {
         fputc('.', stream);
     }
 }
@@ -361,7 +667,7 @@ void board_serialize(const board_t* board, FILE* stream) {
             if (col > 0) {
                 fputc(' ', stream);
             }
-            serialize_cell(board_access_const(board, row, col), stream);
+            serialize_cell(board, row, col, stream);
         }
         fputc('\n', stream);
     }
@@ -371,8 +677,9 @@ static deserialize_status_t handle_scanf_err(FILE* stream) {
     return ferror(stream) ? DS_ERR_IO : DS_ERR_FMT;
 }
 
-static deserialize_status_t deserialize_cell(cell_t* cell, int block_size,
+static deserialize_status_t deserialize_cell(board_t* board, int row, int col,
                                              FILE* stream) {
+    int block_size = board_block_size(board);
     int value;
     int next_char;
 
@@ -384,7 +691,7 @@ static deserialize_status_t deserialize_cell(cell_t* cell, int block_size,
         return DS_ERR_CELL;
     }
 
-    cell->value = value;
+    board_set_value(board, row, col, value);
 
     next_char = fgetc(stream);
 
@@ -393,7 +700,7 @@ static deserialize_status_t deserialize_cell(cell_t* cell, int block_size,
             /* fixed empty cell */
             return DS_ERR_CELL;
         } else {
-            cell->flags = CF_FIXED;
+            board_set_flags(board, row, col, CF_FIXED);
         }
     } else {
         ungetc(next_char, stream);
@@ -424,9 +731,8 @@ deserialize_status_t board_deserialize(board_t* board, FILE* stream) {
 
     for (row = 0; row < block_size; row++) {
         for (col = 0; col < block_size; col++) {
-            cell_t* cell = board_access(board, row, col);
             deserialize_status_t cell_status =
-                deserialize_cell(cell, block_size, stream);
+                deserialize_cell(board, row, col, stream);
 
             if (cell_status != DS_OK) {
                 board_destroy(board);
@@ -441,5 +747,8 @@ deserialize_status_t board_deserialize(board_t* board, FILE* stream) {
         return DS_ERR_FMT;
     }
 
+    /* Conflicts are still tracked, but errors are only marked on request. */
+    clear_errors(board);
+
     return DS_OK;
 }
@@ -6,7 +6,9 @@
 #ifndef BOARD_H
 #define BOARD_H
 
+#include "bitset.h"
 #include "bool.h"
+#include "geometry.h"
 #include <stddef.h>
 #include <stdio.h>
 
@@ -20,42 +22,61 @@ typedef enum cell_flags {
 } cell_flags_t;
 
 /**
- * Represents a single cell on the board.
+ * Hash of board contents. Zobrist hashes are the XOR of a pseudo-random key
+ * for every filled cell and its value, so they can be updated in constant time
+ * whenever a single cell changes.
  */
-typedef struct cell {
-    int value;
-    cell_flags_t flags;
-} cell_t;
+typedef unsigned long board_hash_t;
 
 /**
  * Represents a board containing n rows of m blocks, where each block contains m
  * rows of n cells ((nm)^2 cells in total).
+ *
+ * Cell values are stored in a packed array, in the order of the board's cell
+ * layout, of `unsigned char` (when the block size fits in one) or
+ * `unsigned short`. Exactly one of `values8` and `values16` is allocated. Cell
+ * flags are stored as two bitsets with a bit per cell, one for fixed cells and
+ * one for cells marked as errors; a cell is never in both.
+ *
+ * Alongside the cells themselves, the board tracks how many times each value
+ * occurs in each row, column and block, a bitset of the values present in each
+ * of them, the number of neighbors each cell conflicts with, and board-wide
+ * counts of empty cells and conflicting pairs, and a Zobrist hash of the cell
+ * values. This bookkeeping is only kept up to date when cell values are written
+ * through `board_set_value`.
  */
 typedef struct board {
-    cell_t* cells;
     int m;
     int n;
-} board_t;
 
-/**
- * Check whether `cell` is empty (has value 0).
- */
-bool_t cell_is_empty(const cell_t* cell);
+    const geometry_t* geom; /* Shared unit and peer tables */
 
-/**
- * Check whether `cell` is fixed.
- */
-bool_t cell_is_fixed(const cell_t* cell);
+    unsigned char* values8;   /* Packed values for block sizes up to 255 */
+    unsigned short* values16; /* Packed values for larger block sizes */
+    bitset_word_t* fixed;     /* Bitset of fixed cells */
+    bitset_word_t* errors;    /* Bitset of cells marked as errors */
+
+    int mask_words;            /* Number of words in each unit mask */
+    int* unit_counts;          /* Per-unit value occurrence counts */
+    bitset_word_t* unit_masks; /* Per-unit bitsets of occupied values */
+    int* conflicts;            /* Per-cell count of conflicting neighbors */
+    int empty_count;           /* Number of empty cells */
+    int conflict_count;        /* Number of conflicting pairs of cells */
+    board_hash_t hash;         /* Zobrist hash of the cell values */
+} board_t;
 
 /**
- * Check whether `cell` has been marked as an error.
+ * Initialize a new board with the specified `m` and `n`, with cells laid out in
+ * row-major order.
  */
-bool_t cell_is_error(const cell_t* cell);
+void board_init(board_t* board, int m, int n);
 
 /**
- * Initialize a new board with the specified `m` and `n`.
+ * Initialize a new board with the specified `m`, `n` and cell layout. The
+ * layout only affects the order of the packed value array and flag bitsets:
+ * all positional accessors translate coordinates as needed.
  */
-void board_init(board_t* board, int m, int n);
+void board_init_layout(board_t* board, int m, int n, board_layout_t layout);
 
 /**
  * Destroy `board`, releasing any allocated resources.
@@ -67,12 +88,24 @@ void board_destroy(board_t* board);
  */
 void board_clone(board_t* dest, const board_t* src);
 
+/**
+ * Copy the contents of `src` into the already-initialized `dest`. The two
+ * boards should have the same dimensions and layout. The values and flags are
+ * copied, along with all bookkeeping.
+ */
+void board_assign(board_t* dest, const board_t* src);
+
 /**
  * Retrieve the block size of `board`. This is also the number of rows and
  * columns on the board.
  */
 int board_block_size(const board_t* board);
 
+/**
+ * Retrieve the cell layout of `board`.
+ */
+board_layout_t board_get_layout(const board_t* board);
+
 /**
  * Compute the row in which the cell at the specified position within the
  * specified block resides.
@@ -86,19 +119,122 @@ int board_block_row(const board_t* board, int block_row, int local_row);
 int board_block_col(const board_t* board, int block_col, int local_col);
 
 /**
- * Retrieve the cell at the specified row and column on the board.
+ * Compute the index of the block containing the specified position, in the
+ * same row-major block order used when checking legality.
+ */
+int board_block_index(const board_t* board, int row, int col);
+
+/**
+ * Compute the index in the board's cell layout of the cell at the specified row
+ * and column. This is the index used by the board's geometry tables.
+ */
+int board_cell_index(const board_t* board, int row, int col);
+
+/**
+ * Compute the row and column of the cell at the specified index in the board's
+ * cell layout. This is the inverse of `board_cell_index`.
+ */
+void board_cell_position(const board_t* board, int idx, int* row, int* col);
+
+/**
+ * Retrieve the value of the cell at the specified row and column, or 0 if it
+ * is empty.
+ */
+int board_get_value(const board_t* board, int row, int col);
+
+/**
+ * Equivalent to `board_get_value`, but takes a cell index.
+ */
+int board_get_value_at(const board_t* board, int idx);
+
+/**
+ * Retrieve the flags of the cell at the specified row and column.
+ */
+cell_flags_t board_get_flags(const board_t* board, int row, int col);
+
+/**
+ * Equivalent to `board_get_flags`, but takes a cell index.
+ */
+cell_flags_t board_get_flags_at(const board_t* board, int idx);
+
+/**
+ * Set the flags of the cell at the specified row and column. Error flags are
+ * also kept up to date by `board_set_value`.
+ */
+void board_set_flags(board_t* board, int row, int col, cell_flags_t flags);
+
+/**
+ * Equivalent to `board_set_flags`, but takes a cell index.
+ */
+void board_set_flags_at(board_t* board, int idx, cell_flags_t flags);
+
+/**
+ * Set the value of the cell at the specified position, updating the occupancy
+ * data of its row, column and block.
+ *
+ * Conflicts are tracked incrementally: the error flags of the cell and of any
+ * neighbors whose conflict status changes are updated, so that `CF_ERROR` stays
+ * correct without calling `board_mark_errors`.
+ */
+void board_set_value(board_t* board, int row, int col, int value);
+
+/**
+ * Equivalent to `board_set_value`, but takes a cell index.
  */
-cell_t* board_access(board_t* board, int row, int col);
-const cell_t* board_access_const(const board_t* board, int row, int col);
+void board_set_value_at(board_t* board, int idx, int value);
+
+/**
+ * Retrieve the Zobrist key of the cell at index `idx` holding `value`.
+ */
+board_hash_t board_zobrist_key(int idx, int value);
+
+/**
+ * Retrieve the Zobrist hash of the values on `board`: the XOR of the keys of
+ * its filled cells, which is 0 for an empty board. Cells are identified by
+ * index, so hashes are only comparable between boards of the same dimensions
+ * and layout. The hash is maintained incrementally by `board_set_value`.
+ */
+board_hash_t board_hash(const board_t* board);
+
+/**
+ * Check whether `value` can be placed at the specified position without
+ * conflicting with any other cell in its row, column or block. The current
+ * contents of the position itself are ignored.
+ */
+bool_t board_is_legal_placement(const board_t* board, int row, int col,
+                                int value);
+
+/**
+ * Equivalent to `board_is_legal_placement`, but takes a cell index.
+ */
+bool_t board_is_legal_placement_at(const board_t* board, int idx, int value);
 
 /**
  * Check whether `board` is legal (in the sense that no two "neighbors" share
- * the same value).
+ * the same value), in constant time.
  */
 bool_t board_is_legal(const board_t* board);
 
 /**
- * Mark conflicting non-fixed cells on the board as errors.
+ * Check whether `board` has no empty cells, in constant time.
+ */
+bool_t board_is_full(const board_t* board);
+
+/**
+ * Check whether any two neighbors on `board` share the same value, in constant
+ * time.
+ */
+bool_t board_has_conflicts(const board_t* board);
+
+/**
+ * Check whether `board` is completely and legally filled, in constant time.
+ */
+bool_t board_is_solved(const board_t* board);
+
+/**
+ * Mark conflicting non-fixed cells on the board as errors, rechecking the
+ * entire board. This is only necessary after cell flags have been changed
+ * directly; value changes keep error flags up to date on their own.
  */
 void board_mark_errors(board_t* board);
 
@@ -122,6 +258,45 @@ int board_gather_candidates(board_t* board, int row, int col, int* candidates);
 bool_t board_get_single_candidate(board_t* board, int row, int col,
                                   int* candidate);
 
+/**
+ * Candidate values for every cell of a board, stored as one bitset per cell in
+ * row-major order. Bit `val - 1` of a cell's bitset is set when `val` is a
+ * legal value for that cell.
+ */
+typedef struct board_candidates {
+    const geometry_t* geom; /* Geometry of the board, for cell lookup */
+    int words;              /* Number of words in each cell's bitset */
+    bitset_word_t* sets;    /* `block_size * block_size` bitsets */
+} board_candidates_t;
+
+/**
+ * Compute the candidate values of every empty cell of `board` in a single
+ * pass, storing them to `candidates`, which should be cleaned up with
+ * `board_candidates_destroy` after use. Non-empty cells are given no
+ * candidates, as are all cells if the board already contains a conflict.
+ */
+void board_compute_all_candidates(const board_t* board,
+                                  board_candidates_t* candidates);
+
+/**
+ * Deallocate any memory held by `candidates`.
+ */
+void board_candidates_destroy(board_candidates_t* candidates);
+
+/**
+ * Retrieve the candidate bitset of the specified position.
+ */
+const bitset_word_t*
+board_candidates_access(const board_candidates_t* candidates, int row,
+                        int col);
+
+/**
+ * Retrieve the candidate bitset of the cell at the specified index in the
+ * board's cell layout.
+ */
+const bitset_word_t*
+board_candidates_access_at(const board_candidates_t* candidates, int idx);
+
 /**
  * Print `board` to `stream` in a human-readable format. If `mark_errors` is
  * true, erroneous cells (those with `CF_ERROR` set) will be printed with an
@@ -149,7 +324,8 @@ void board_serialize(const board_t* board, FILE* stream);
  * (status `DS_OK`), the board should be cleaned up with `board_destroy` after
  * use.
  * Note that this function does not check the legality of the resulting board in
- * any way.
+ * any way, and the loaded cells are not marked as errors - use
+ * `board_mark_errors` to do so.
  */
 deserialize_status_t board_deserialize(board_t* board, FILE* stream);
 
@@ -0,0 +1,341 @@
+#include "canon.h"
+
+#include "checked_alloc.h"
+#include "hash.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct canon_ctx {
+    int m;
+    int n;
+    int block_size;
+
+    const int* src; /* Source values in row-major order, possibly transposed */
+    bool_t transposed;
+
+    /* Current arrangement of columns and rows. */
+    int cols[CANON_MAX_BLOCK_SIZE];
+    bool_t col_used[CANON_MAX_BLOCK_SIZE];
+    int rows[CANON_MAX_BLOCK_SIZE];
+    bool_t row_used[CANON_MAX_BLOCK_SIZE];
+
+    /* Labels given to values in order of first appearance, 0 if none yet. */
+    int labels[CANON_MAX_BLOCK_SIZE + 1];
+    int next_label;
+
+    int* current; /* Relabeled rows placed so far */
+
+    /* Smallest board found so far. */
+    bool_t found;
+    int updates; /* Number of times `best` has been replaced */
+    int* best;
+    canon_transform_t best_transform;
+} canon_ctx_t;
+
+/**
+ * Compare the `count` values of `a` and `b` lexicographically.
+ */
+static int compare_values(const int* a, const int* b, int count) {
+    int i;
+
+    for (i = 0; i < count; i++) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Record the current arrangement as the smallest found so far.
+ */
+static void record_best(canon_ctx_t* ctx) {
+    canon_transform_t* transform = &ctx->best_transform;
+    int block_size = ctx->block_size;
+    int label = ctx->next_label;
+    int value;
+
+    memcpy(ctx->best, ctx->current, block_size * block_size * sizeof(int));
+
+    transform->transposed = ctx->transposed;
+    memcpy(transform->rows, ctx->rows, block_size * sizeof(int));
+    memcpy(transform->cols, ctx->cols, block_size * sizeof(int));
+
+    /* Values missing from the board keep their relative order. */
+    transform->values[0] = 0;
+    for (value = 1; value <= block_size; value++) {
+        transform->values[value] =
+            ctx->labels[value] ? ctx->labels[value] : label++;
+    }
+
+    ctx->found = TRUE;
+    ctx->updates++;
+}
+
+/**
+ * Place source row `row` at position `slot` under the current columns,
+ * labeling any values seen for the first time.
+ */
+static void place_row(canon_ctx_t* ctx, int slot, int row) {
+    int block_size = ctx->block_size;
+    int* dest = &ctx->current[slot * block_size];
+    int j;
+
+    for (j = 0; j < block_size; j++) {
+        int value = ctx->src[row * block_size + ctx->cols[j]];
+
+        if (value && !ctx->labels[value]) {
+            ctx->labels[value] = ctx->next_label++;
+        }
+        dest[j] = ctx->labels[value];
+    }
+}
+
+/**
+ * Try every arrangement of the rows from position `slot` on. `tight` is set if
+ * the rows placed so far are identical to those of the best board, in which
+ * case arrangements are pruned as soon as they compare greater.
+ */
+static void arrange_rows(canon_ctx_t* ctx, int slot, bool_t tight) {
+    int block_size = ctx->block_size;
+    int labels[CANON_MAX_BLOCK_SIZE + 1];
+    int next_label = ctx->next_label;
+    int first;
+    int last;
+    int row;
+
+    if (slot == block_size) {
+        if (!tight) {
+            record_best(ctx);
+        }
+        return;
+    }
+
+    /* Rows starting a band may come from any unused band, while the others
+     * must come from the same band as the row before them. */
+    if (slot % ctx->m == 0) {
+        first = 0;
+        last = block_size;
+    } else {
+        first = ctx->rows[slot - 1] / ctx->m * ctx->m;
+        last = first + ctx->m;
+    }
+
+    memcpy(labels, ctx->labels, (block_size + 1) * sizeof(int));
+
+    for (row = first; row < last; row++) {
+        bool_t child_tight = FALSE;
+        int updates = ctx->updates;
+
+        if (ctx->row_used[row]) {
+            /* Skip the rest of a used band at once. */
+            if (slot % ctx->m == 0) {
+                row = row / ctx->m * ctx->m + ctx->m - 1;
+            }
+            continue;
+        }
+
+        place_row(ctx, slot, row);
+
+        if (tight) {
+            int cmp = compare_values(&ctx->current[slot * block_size],
+                                     &ctx->best[slot * block_size], block_size);
+            child_tight = cmp == 0;
+
+            if (cmp > 0) {
+                memcpy(ctx->labels, labels, (block_size + 1) * sizeof(int));
+                ctx->next_label = next_label;
+                continue;
+            }
+        }
+
+        ctx->rows[slot] = row;
+        ctx->row_used[row] = TRUE;
+        arrange_rows(ctx, slot + 1, child_tight);
+        ctx->row_used[row] = FALSE;
+
+        memcpy(ctx->labels, labels, (block_size + 1) * sizeof(int));
+        ctx->next_label = next_label;
+
+        /* A better board below shares the rows placed so far. */
+        if (ctx->updates != updates) {
+            tight = TRUE;
+        }
+    }
+}
+
+/**
+ * Try every arrangement of the columns from position `slot` on, searching the
+ * rows under each complete arrangement.
+ */
+static void arrange_cols(canon_ctx_t* ctx, int slot) {
+    int first;
+    int last;
+    int col;
+
+    if (slot == ctx->block_size) {
+        arrange_rows(ctx, 0, ctx->found);
+        return;
+    }
+
+    if (slot % ctx->n == 0) {
+        first = 0;
+        last = ctx->block_size;
+    } else {
+        first = ctx->cols[slot - 1] / ctx->n * ctx->n;
+        last = first + ctx->n;
+    }
+
+    for (col = first; col < last; col++) {
+        if (ctx->col_used[col]) {
+            if (slot % ctx->n == 0) {
+                col = col / ctx->n * ctx->n + ctx->n - 1;
+            }
+            continue;
+        }
+
+        ctx->cols[slot] = col;
+        ctx->col_used[col] = TRUE;
+        arrange_cols(ctx, slot + 1);
+        ctx->col_used[col] = FALSE;
+    }
+}
+
+/**
+ * Count the column arrangements of an `m`x`n` geometry, stopping once the
+ * count exceeds `CANON_MAX_ARRANGEMENTS`.
+ */
+static long count_arrangements(int m, int n) {
+    long count = 1;
+    int i;
+    int j;
+
+    /* m! stack orders, and n! column orders within each of the m stacks. */
+    for (i = 2; i <= m && count <= CANON_MAX_ARRANGEMENTS; i++) {
+        count *= i;
+    }
+    for (i = 0; i < m && count <= CANON_MAX_ARRANGEMENTS; i++) {
+        for (j = 2; j <= n && count <= CANON_MAX_ARRANGEMENTS; j++) {
+            count *= j;
+        }
+    }
+
+    return count;
+}
+
+bool_t canon_board(const board_t* board, board_t* canonical,
+                   canon_transform_t* transform, canon_hash_t* hash) {
+    canon_ctx_t ctx;
+    int block_size = board_block_size(board);
+    int* values;
+    int* transposed;
+    int row;
+    int col;
+
+    if (block_size > CANON_MAX_BLOCK_SIZE ||
+        count_arrangements(board->m, board->n) > CANON_MAX_ARRANGEMENTS) {
+        return FALSE;
+    }
+
+    values = checked_calloc(block_size * block_size, sizeof(int));
+    transposed = checked_calloc(block_size * block_size, sizeof(int));
+    for (row = 0; row < block_size; row++) {
+        for (col = 0; col < block_size; col++) {
+            int value = board_get_value(board, row, col);
+
+            values[row * block_size + col] = value;
+            transposed[col * block_size + row] = value;
+        }
+    }
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.m = board->m;
+    ctx.n = board->n;
+    ctx.block_size = block_size;
+    ctx.next_label = 1;
+    ctx.current = checked_calloc(block_size * block_size, sizeof(int));
+    ctx.best = checked_calloc(block_size * block_size, sizeof(int));
+
+    ctx.src = values;
+    ctx.transposed = FALSE;
+    arrange_cols(&ctx, 0);
+
+    /* Transposing only preserves the geometry when blocks are square. */
+    if (board->m == board->n) {
+        ctx.src = transposed;
+        ctx.transposed = TRUE;
+        arrange_cols(&ctx, 0);
+    }
+
+    board_init(canonical, board->m, board->n);
+    for (row = 0; row < block_size; row++) {
+        for (col = 0; col < block_size; col++) {
+            board_set_value(canonical, row, col,
+                            ctx.best[row * block_size + col]);
+        }
+    }
+
+    if (transform) {
+        *transform = ctx.best_transform;
+    }
+    if (hash) {
+        canon_hash(canonical, hash);
+    }
+
+    free(ctx.best);
+    free(ctx.current);
+    free(transposed);
+    free(values);
+
+    return TRUE;
+}
+
+void canon_apply(const board_t* board, const canon_transform_t* transform,
+                 board_t* dest) {
+    int block_size = board_block_size(board);
+    int row;
+    int col;
+
+    board_init(dest, board->m, board->n);
+
+    for (row = 0; row < block_size; row++) {
+        for (col = 0; col < block_size; col++) {
+            int src_row = transform->rows[row];
+            int src_col = transform->cols[col];
+            int value;
+
+            if (transform->transposed) {
+                int tmp = src_row;
+                src_row = src_col;
+                src_col = tmp;
+            }
+
+            value = board_get_value(board, src_row, src_col);
+            board_set_value(dest, row, col, transform->values[value]);
+        }
+    }
+}
+
+void canon_hash(const board_t* board, canon_hash_t* hash) {
+    int block_size = board_block_size(board);
+    int row;
+    int col;
+
+    /* Two independently-seeded chains over the values, in row-major order. */
+    hash->lo = hash_mix(HASH_GOLDEN_GAMMA + board->m);
+    hash->hi = hash_mix(HASH_CONSTANT(0xc2b2ae3dUL, 0x27d4eb4fUL) + board->n);
+
+    for (row = 0; row < block_size; row++) {
+        for (col = 0; col < block_size; col++) {
+            unsigned long value = board_get_value(board, row, col);
+
+            hash->lo = hash_mix(hash->lo + value + 1);
+            hash->hi = hash_mix((hash->hi ^ value) + 0x632be5abUL);
+        }
+    }
+}
+
+bool_t canon_hash_equal(const canon_hash_t* a, const canon_hash_t* b) {
+    return a->hi == b->hi && a->lo == b->lo;
+}
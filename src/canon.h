@@ -0,0 +1,83 @@
+/**
+ * canon.h - Canonical forms of boards under the symmetries of Sudoku.
+ */
+
+#ifndef CANON_H
+#define CANON_H
+
+#include "board.h"
+#include "bool.h"
+
+/**
+ * Largest block size for which canonical forms are computed. This is the
+ * largest block size with a geometry (5x3) within `CANON_MAX_ARRANGEMENTS`:
+ * every 16-cell geometry (4x4, 2x8 and 8x2) has millions of column
+ * arrangements, as do some smaller ones such as 3x5.
+ */
+#define CANON_MAX_BLOCK_SIZE 15
+
+/**
+ * Largest number of column arrangements (stack orders times column orders
+ * within stacks) searched. Geometries with more are not canonicalized.
+ */
+#define CANON_MAX_ARRANGEMENTS (1L << 20)
+
+/**
+ * A symmetry of a board: the canonical board holds, at row `i` and column `j`,
+ * the value `values[v]` where `v` is the value of the source board at row
+ * `rows[i]` and column `cols[j]` (or at row `cols[j]` and column `rows[i]` if
+ * `transposed` is set). `values[0]` is always 0.
+ */
+typedef struct canon_transform {
+    bool_t transposed;
+    int rows[CANON_MAX_BLOCK_SIZE];
+    int cols[CANON_MAX_BLOCK_SIZE];
+    int values[CANON_MAX_BLOCK_SIZE + 1];
+} canon_transform_t;
+
+/**
+ * A 128-bit hash of a canonical board.
+ */
+typedef struct canon_hash {
+    unsigned long hi;
+    unsigned long lo;
+} canon_hash_t;
+
+/**
+ * Compute the canonical form of `board` under value relabeling, permutations
+ * of the rows within a band and of the bands, permutations of the columns
+ * within a stack and of the stacks, and transposition (for square blocks).
+ *
+ * The canonical board is the one whose values, read in row-major order, are
+ * lexicographically smallest, with empty cells sorting first. Equivalent
+ * boards therefore share a canonical board and hash. On success, `canonical`
+ * is initialized with the canonical board (values only, in row-major layout),
+ * `*transform` receives a symmetry mapping `board` to it and `*hash` receives
+ * its hash. Either of `transform` and `hash` may be NULL.
+ *
+ * Every arrangement of the columns is tried, with a pruned search over the
+ * rows under each one. Returns false, initializing nothing, if the block size
+ * exceeds `CANON_MAX_BLOCK_SIZE` or the geometry has more than
+ * `CANON_MAX_ARRANGEMENTS` column arrangements.
+ */
+bool_t canon_board(const board_t* board, board_t* canonical,
+                   canon_transform_t* transform, canon_hash_t* hash);
+
+/**
+ * Initialize `dest` with the image of `board` under `transform`.
+ */
+void canon_apply(const board_t* board, const canon_transform_t* transform,
+                 board_t* dest);
+
+/**
+ * Compute the 128-bit hash of the values of `board`, which should already be
+ * canonical.
+ */
+void canon_hash(const board_t* board, canon_hash_t* hash);
+
+/**
+ * Check whether two hashes are equal.
+ */
+bool_t canon_hash_equal(const canon_hash_t* a, const canon_hash_t* b);
+
+#endif
@@ -0,0 +1,321 @@
+#include "checkpoint.h"
+
+#include "bitset.h"
+#include "checked_alloc.h"
+#include "search.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * First line of every checkpoint file, identifying its format version.
+ */
+#define CHECKPOINT_MAGIC "sudoku-checkpoint 2"
+
+/**
+ * Largest block dimension accepted when reading a checkpoint.
+ */
+#define CHECKPOINT_MAX_DIM 64
+
+/**
+ * Write the state of `search`, counting the solutions of `board`, to `stream`.
+ *
+ * The checkpoint consists of the magic line, the board layout and size, the
+ * progress of the count, one line per frame of the frontier (its cell, the
+ * value being explored there and the values left to try) and finally the board
+ * itself.
+ */
+static void write_state(const search_t* search, const board_t* board,
+                        FILE* stream) {
+    int i;
+
+    fprintf(stream, "%s\n", CHECKPOINT_MAGIC);
+    fprintf(stream, "layout %d size %d %d\n", (int)board_get_layout(board),
+            board->m, board->n);
+    fprintf(stream, "count %ld nodes %ld depth %d\n", search->count,
+            search->nodes, search->depth - search->base_depth);
+
+    for (i = search->base_depth; i < search->depth; i++) {
+        const search_frame_t* frame = &search->frames[i];
+        int bit;
+
+        fprintf(stream, "%d %d %d", frame->cell, frame->value,
+                bitset_count(frame->remaining, search->words));
+        for (bit = bitset_next(frame->remaining, search->words, 0); bit != -1;
+             bit = bitset_next(frame->remaining, search->words, bit + 1)) {
+            fprintf(stream, " %d", bit + 1);
+        }
+        fputc('\n', stream);
+    }
+
+    board_serialize(board, stream);
+}
+
+/**
+ * Atomically replace the checkpoint at `path` with the state of `search`.
+ */
+static bool_t save(const search_t* search, const board_t* board,
+                   const char* path) {
+    char* tmp_path = checked_malloc(strlen(path) + sizeof(".tmp"));
+    FILE* stream;
+    bool_t ret = FALSE;
+
+    sprintf(tmp_path, "%s.tmp", path);
+
+    stream = fopen(tmp_path, "w");
+    if (!stream) {
+        goto cleanup;
+    }
+
+    write_state(search, board, stream);
+
+    if (ferror(stream)) {
+        fclose(stream);
+        remove(tmp_path);
+        goto cleanup;
+    }
+
+    if (fclose(stream) || rename(tmp_path, path)) {
+        remove(tmp_path);
+        goto cleanup;
+    }
+
+    ret = TRUE;
+
+cleanup:
+    free(tmp_path);
+    return ret;
+}
+
+/**
+ * Continue the count in `search` until it finishes or `opts->max_nodes`
+ * values have been tried, checkpointing every `opts->interval` values.
+ */
+static checkpoint_status_t run(search_t* search, const board_t* board,
+                               const checkpoint_opts_t* opts, long* count) {
+    long tried = 0;
+
+    for (;;) {
+        long step = opts->interval;
+        long start = search->nodes;
+        bool_t done;
+
+        if (opts->max_nodes) {
+            long left = opts->max_nodes - tried;
+            if (step <= 0 || left < step) {
+                step = left;
+            }
+        } else if (step < 0) {
+            step = 0;
+        }
+
+        done = search_resume(search, 0, step);
+        tried += search->nodes - start;
+        *count = search->count;
+
+        if (done) {
+            remove(opts->path);
+            return CP_DONE;
+        }
+
+        if (!save(search, board, opts->path)) {
+            return CP_ERR_IO;
+        }
+
+        if (opts->max_nodes && tried >= opts->max_nodes) {
+            return CP_INTERRUPTED;
+        }
+    }
+}
+
+checkpoint_status_t checkpoint_count(const board_t* board,
+                                     const checkpoint_opts_t* opts,
+                                     long* count) {
+    search_t search;
+    checkpoint_status_t status;
+
+    search_init(&search, board);
+    search_begin(&search);
+    status = run(&search, board, opts, count);
+    search_destroy(&search);
+
+    return status;
+}
+
+/**
+ * Rebuild `board` in `layout`, which is row-major when freshly deserialized.
+ */
+static void relayout(board_t* board, board_layout_t layout) {
+    board_t copy;
+    int block_size = board_block_size(board);
+    int row;
+    int col;
+
+    if (layout == board_get_layout(board)) {
+        return;
+    }
+
+    board_init_layout(&copy, board->m, board->n, layout);
+    for (row = 0; row < block_size; row++) {
+        for (col = 0; col < block_size; col++) {
+            board_set_value(&copy, row, col, board_get_value(board, row, col));
+            board_set_flags(&copy, row, col, board_get_flags(board, row, col));
+        }
+    }
+
+    board_destroy(board);
+    *board = copy;
+}
+
+/**
+ * Read the frontier saved by `write_state` into `cells`, `values` and
+ * `remaining`, which must have room for `depth` frames of values up to
+ * `block_size`.
+ */
+static checkpoint_status_t read_frames(FILE* stream, int depth,
+                                       int block_size, int* cells, int* values,
+                                       bitset_word_t* remaining) {
+    int words = BITSET_WORDS(block_size);
+    int i;
+
+    for (i = 0; i < depth; i++) {
+        bitset_word_t* set = &remaining[i * words];
+        int k;
+        int j;
+
+        if (fscanf(stream, "%d %d %d", &cells[i], &values[i], &k) < 3) {
+            return ferror(stream) ? CP_ERR_IO : CP_ERR_FMT;
+        }
+        if (k < 0 || k > block_size) {
+            return CP_ERR_FMT;
+        }
+
+        for (j = 0; j < k; j++) {
+            int value;
+
+            if (fscanf(stream, "%d", &value) < 1) {
+                return ferror(stream) ? CP_ERR_IO : CP_ERR_FMT;
+            }
+            if (value < 1 || value > block_size) {
+                return CP_ERR_FMT;
+            }
+            BITSET_SET(set, value - 1);
+        }
+    }
+
+    return CP_DONE;
+}
+
+/**
+ * Check that the saved frames only refer to cells and values of the board.
+ * Whether they are consistent with it is checked by `search_restore`.
+ */
+static bool_t frames_valid(const search_t* search, int depth, const int* cells,
+                           const int* values) {
+    int i;
+
+    for (i = 0; i < depth; i++) {
+        if (cells[i] < 0 || cells[i] >= search->geom->cell_count ||
+            values[i] < 0 || values[i] > search->block_size) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+checkpoint_status_t checkpoint_resume(const checkpoint_opts_t* opts,
+                                      long* count) {
+    FILE* stream;
+    char magic[sizeof(CHECKPOINT_MAGIC)];
+    int layout;
+    int m, n;
+    long saved_count;
+    long nodes;
+    int depth;
+    board_t board;
+    search_t search;
+
+    int* cells = NULL;
+    int* values = NULL;
+    bitset_word_t* remaining = NULL;
+    int words;
+
+    checkpoint_status_t status = CP_ERR_FMT;
+
+    stream = fopen(opts->path, "r");
+    if (!stream) {
+        return CP_ERR_IO;
+    }
+
+    if (!fgets(magic, sizeof(magic), stream) ||
+        strcmp(magic, CHECKPOINT_MAGIC)) {
+        goto cleanup_stream;
+    }
+
+    if (fscanf(stream, " layout %d size %d %d count %ld nodes %ld depth %d",
+               &layout, &m, &n, &saved_count, &nodes, &depth) < 6) {
+        status = ferror(stream) ? CP_ERR_IO : CP_ERR_FMT;
+        goto cleanup_stream;
+    }
+
+    if ((layout != BL_ROW_MAJOR && layout != BL_BLOCK_MAJOR) || m <= 0 ||
+        n <= 0 || m > CHECKPOINT_MAX_DIM || n > CHECKPOINT_MAX_DIM ||
+        saved_count < 0 || nodes < 0 || depth < 0 ||
+        depth > m * n * m * n) {
+        goto cleanup_stream;
+    }
+
+    cells = checked_calloc(depth + 1, sizeof(int));
+    values = checked_calloc(depth + 1, sizeof(int));
+    words = BITSET_WORDS(m * n);
+    remaining = checked_calloc((depth + 1) * words, sizeof(bitset_word_t));
+
+    status = read_frames(stream, depth, m * n, cells, values, remaining);
+    if (status != CP_DONE) {
+        goto cleanup_frames;
+    }
+
+    switch (board_deserialize(&board, stream)) {
+    case DS_OK:
+        break;
+    case DS_ERR_IO:
+        status = CP_ERR_IO;
+        goto cleanup_frames;
+    default:
+        status = CP_ERR_FMT;
+        goto cleanup_frames;
+    }
+
+    fclose(stream);
+    stream = NULL;
+    status = CP_ERR_FMT;
+
+    if (board.m != m || board.n != n) {
+        board_destroy(&board);
+        goto cleanup_frames;
+    }
+
+    relayout(&board, (board_layout_t)layout);
+    search_init(&search, &board);
+
+    if (frames_valid(&search, depth, cells, values) &&
+        search_restore(&search, saved_count, nodes, depth, cells, values,
+                       remaining)) {
+        status = run(&search, &board, opts, count);
+    }
+
+    search_destroy(&search);
+    board_destroy(&board);
+
+cleanup_frames:
+    free(remaining);
+    free(values);
+    free(cells);
+
+cleanup_stream:
+    if (stream) {
+        fclose(stream);
+    }
+    return status;
+}
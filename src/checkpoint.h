@@ -0,0 +1,51 @@
+/**
+ * checkpoint.h - Resumable solution counting backed by checkpoint files.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "board.h"
+#include "bool.h"
+
+/**
+ * Status code returned from checkpointed counts.
+ */
+typedef enum checkpoint_status {
+    CP_DONE,        /* The count finished */
+    CP_INTERRUPTED, /* The node budget ran out - resume from the checkpoint */
+    CP_ERR_IO,      /* The checkpoint file could not be read or written */
+    CP_ERR_FMT      /* The checkpoint file is malformed */
+} checkpoint_status_t;
+
+/**
+ * Options controlling a checkpointed count.
+ */
+typedef struct checkpoint_opts {
+    const char* path; /* Checkpoint file */
+    long interval;    /* Values tried between checkpoints */
+    long max_nodes;   /* Values to try before stopping, or 0 for no limit */
+} checkpoint_opts_t;
+
+/**
+ * Count the solutions of `board`, writing the board, the partial count and the
+ * search frontier to `opts->path` every `opts->interval` values tried.
+ * Checkpoints are written to a temporary file first and then renamed, so an
+ * interrupted write never destroys the previous checkpoint.
+ *
+ * On `CP_DONE`, `*count` receives the total and the checkpoint file is
+ * removed. On `CP_INTERRUPTED`, `*count` receives the partial count and the
+ * checkpoint file is left up to date.
+ */
+checkpoint_status_t checkpoint_count(const board_t* board,
+                                     const checkpoint_opts_t* opts,
+                                     long* count);
+
+/**
+ * Resume a count from the checkpoint stored at `opts->path`, continuing to
+ * write checkpoints there as in `checkpoint_count`.
+ */
+checkpoint_status_t checkpoint_resume(const checkpoint_opts_t* opts,
+                                      long* count);
+
+#endif
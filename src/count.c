@@ -0,0 +1,266 @@
+/**
+ * count.c - Command-line solution counter for long-running and sharded counts.
+ *
+ * Usage:
+ *   sudoku-count [--shard I/N] BOARD
+ *   sudoku-count --checkpoint PATH [--interval VALUES] BOARD
+ *   sudoku-count --resume PATH [--interval VALUES]
+ *   sudoku-count --merge [RESULTS...]
+ *   sudoku-count --estimate PROBES BOARD
+ *   sudoku-count --bands BOARD
+ *
+ * With `--shard`, only shard I (0-based) of N is counted and the result is
+ * printed in the format understood by `--merge`, which sums the results of
+ * all N shards read from the given files (or standard input). `--estimate`
+ * reports an approximate count with its 95% confidence interval instead, and
+ * `--bands` counts sparse boards exactly with arbitrary precision (though not
+ * the empty 9x9 board; see bandcount.h).
+ */
+
+#include "backtrack.h"
+#include "bandcount.h"
+#include "bignum.h"
+#include "board.h"
+#include "bool.h"
+#include "checkpoint.h"
+#include "shard.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Default number of values tried between checkpoints.
+ */
+#define COUNT_DEFAULT_INTERVAL 100000000L
+
+static int usage(void) {
+    fprintf(stderr, "Usage:\n"
+                    "  sudoku-count [--shard I/N] BOARD\n"
+                    "  sudoku-count --checkpoint PATH [--interval VALUES] "
+                    "BOARD\n"
+                    "  sudoku-count --resume PATH [--interval VALUES]\n"
+                    "  sudoku-count --merge [RESULTS...]\n"
+                    "  sudoku-count --estimate PROBES BOARD\n"
+                    "  sudoku-count --bands BOARD\n");
+    return 2;
+}
+
+static bool_t load_board(board_t* board, const char* path) {
+    FILE* stream = fopen(path, "r");
+    deserialize_status_t status;
+
+    if (!stream) {
+        fprintf(stderr, "Error: could not open '%s'\n", path);
+        return FALSE;
+    }
+
+    status = board_deserialize(board, stream);
+    fclose(stream);
+
+    if (status != DS_OK) {
+        fprintf(stderr, "Error: could not load a board from '%s'\n", path);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static int merge_results(int argc, char** argv) {
+    shard_merge_t merge;
+    shard_merge_status_t status = SM_OK;
+    long count = 0;
+    int i;
+
+    shard_merge_init(&merge);
+
+    if (argc == 0) {
+        status = shard_merge_read(&merge, stdin);
+    }
+
+    for (i = 0; i < argc && status == SM_OK; i++) {
+        FILE* stream = fopen(argv[i], "r");
+
+        if (!stream) {
+            fprintf(stderr, "Error: could not open '%s'\n", argv[i]);
+            shard_merge_destroy(&merge);
+            return 1;
+        }
+
+        status = shard_merge_read(&merge, stream);
+        fclose(stream);
+    }
+
+    if (status == SM_OK) {
+        status = shard_merge_finish(&merge, &count);
+    }
+
+    switch (status) {
+    case SM_OK:
+        printf("%ld\n", count);
+        break;
+    case SM_ERR_FMT:
+        fprintf(stderr, "Error: malformed shard result\n");
+        break;
+    case SM_ERR_MISMATCH:
+        fprintf(stderr, "Error: results have different shard counts\n");
+        break;
+    case SM_ERR_DUPLICATE:
+        fprintf(stderr, "Error: a shard was reported more than once\n");
+        break;
+    case SM_ERR_MISSING:
+        fprintf(stderr, "Error: %d of %d shards reported\n", merge.seen_count,
+                merge.total);
+        break;
+    }
+
+    shard_merge_destroy(&merge);
+    return status == SM_OK ? 0 : 1;
+}
+
+static void report_estimate(board_t* board, long probes) {
+    solution_estimate_t estimate;
+
+    num_solutions_estimate(board, probes, &estimate);
+
+    if (estimate.exact) {
+        printf("%.0f (exact)\n", estimate.count);
+    } else {
+        printf("%.6g (95%% confidence interval %.6g - %.6g, %ld probes)\n",
+               estimate.count, estimate.low, estimate.high, estimate.probes);
+    }
+}
+
+static int report_band_count(const board_t* board) {
+    bignum_t count;
+    bool_t counted;
+
+    bignum_init(&count, 0);
+    counted = band_count(board, &count);
+    if (counted) {
+        bignum_print(&count, stdout);
+        putchar('\n');
+    } else {
+        fprintf(stderr, "Error: boards larger than %dx%d are not supported\n",
+                BAND_COUNT_MAX_BLOCK_SIZE, BAND_COUNT_MAX_BLOCK_SIZE);
+    }
+    bignum_destroy(&count);
+
+    return counted ? 0 : 1;
+}
+
+static int report_checkpoint(checkpoint_status_t status, long count,
+                             const char* path) {
+    switch (status) {
+    case CP_DONE:
+        printf("%ld\n", count);
+        return 0;
+    case CP_INTERRUPTED:
+        printf("%ld so far, resume from '%s'\n", count, path);
+        return 0;
+    case CP_ERR_IO:
+        fprintf(stderr, "Error: could not access checkpoint '%s'\n", path);
+        break;
+    case CP_ERR_FMT:
+        fprintf(stderr, "Error: checkpoint '%s' is malformed\n", path);
+        break;
+    }
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    checkpoint_opts_t opts;
+    const char* resume_path = NULL;
+    long probes = 0;
+    bool_t bands = FALSE;
+    int ret = 0;
+    int shard_index = 0;
+    int shard_total = 0;
+    board_t board;
+    long count = 0;
+    int i;
+
+    opts.path = NULL;
+    opts.interval = COUNT_DEFAULT_INTERVAL;
+    opts.max_nodes = 0;
+
+    for (i = 1; i < argc && !strncmp(argv[i], "--", 2); i++) {
+        const char* opt = argv[i];
+        char extra;
+
+        if (!strcmp(opt, "--merge")) {
+            return merge_results(argc - i - 1, argv + i + 1);
+        }
+
+        if (!strcmp(opt, "--bands")) {
+            bands = TRUE;
+            continue;
+        }
+
+        if (i + 1 == argc) {
+            return usage();
+        }
+        i++;
+
+        if (!strcmp(opt, "--shard")) {
+            if (sscanf(argv[i], "%d/%d%c", &shard_index, &shard_total,
+                       &extra) != 2 ||
+                shard_total <= 0 || shard_index < 0 ||
+                shard_index >= shard_total) {
+                return usage();
+            }
+        } else if (!strcmp(opt, "--checkpoint")) {
+            opts.path = argv[i];
+        } else if (!strcmp(opt, "--resume")) {
+            resume_path = argv[i];
+        } else if (!strcmp(opt, "--estimate")) {
+            if (sscanf(argv[i], "%ld%c", &probes, &extra) != 1 ||
+                probes <= 0) {
+                return usage();
+            }
+        } else if (!strcmp(opt, "--interval")) {
+            if (sscanf(argv[i], "%ld%c", &opts.interval, &extra) != 1 ||
+                opts.interval <= 0) {
+                return usage();
+            }
+        } else {
+            return usage();
+        }
+    }
+
+    if (resume_path) {
+        if (i != argc || opts.path || shard_total || probes || bands) {
+            return usage();
+        }
+        opts.path = resume_path;
+        return report_checkpoint(checkpoint_resume(&opts, &count), count,
+                                 opts.path);
+    }
+
+    if (i + 1 != argc || (!!opts.path + !!shard_total + !!probes + bands) > 1) {
+        return usage();
+    }
+
+    if (!load_board(&board, argv[i])) {
+        return 1;
+    }
+
+    if (opts.path) {
+        checkpoint_status_t status = checkpoint_count(&board, &opts, &count);
+
+        board_destroy(&board);
+        return report_checkpoint(status, count, opts.path);
+    }
+
+    if (bands) {
+        ret = report_band_count(&board);
+    } else if (probes) {
+        report_estimate(&board, probes);
+    } else if (shard_total) {
+        count = shard_count(&board, shard_index, shard_total);
+        shard_print_result(stdout, shard_index, shard_total, count);
+    } else {
+        printf("%ld\n", num_solutions(&board));
+    }
+
+    board_destroy(&board);
+    return ret;
+}
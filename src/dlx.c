@@ -0,0 +1,339 @@
+#include "dlx.h"
+
+#include "bitset.h"
+#include "checked_alloc.h"
+#include "geometry.h"
+#include <stddef.h>
+#include <stdlib.h>
+
+/**
+ * Number of nodes in every matrix row: one for the cell constraint and one for
+ * each of the cell's units.
+ */
+#define DLX_ROW_NODES (1 + UK_COUNT)
+
+/**
+ * Remove column `c` from the header list, along with every matrix row that
+ * intersects it.
+ */
+static void cover(dlx_t* dlx, int c) {
+    int i, j;
+
+    dlx->right[dlx->left[c]] = dlx->right[c];
+    dlx->left[dlx->right[c]] = dlx->left[c];
+
+    for (i = dlx->down[c]; i != c; i = dlx->down[i]) {
+        for (j = dlx->right[i]; j != i; j = dlx->right[j]) {
+            dlx->down[dlx->up[j]] = dlx->down[j];
+            dlx->up[dlx->down[j]] = dlx->up[j];
+            dlx->size[dlx->column[j]]--;
+        }
+    }
+}
+
+/**
+ * Undo `cover(dlx, c)`.
+ */
+static void uncover(dlx_t* dlx, int c) {
+    int i, j;
+
+    for (i = dlx->up[c]; i != c; i = dlx->up[i]) {
+        for (j = dlx->left[i]; j != i; j = dlx->left[j]) {
+            dlx->size[dlx->column[j]]++;
+            dlx->down[dlx->up[j]] = j;
+            dlx->up[dlx->down[j]] = j;
+        }
+    }
+
+    dlx->right[dlx->left[c]] = c;
+    dlx->left[dlx->right[c]] = c;
+}
+
+/**
+ * Cover the columns of every other node in the matrix row of `node`.
+ */
+static void cover_row(dlx_t* dlx, int node) {
+    int j;
+    for (j = dlx->right[node]; j != node; j = dlx->right[j]) {
+        cover(dlx, dlx->column[j]);
+    }
+}
+
+/**
+ * Undo `cover_row(dlx, node)`.
+ */
+static void uncover_row(dlx_t* dlx, int node) {
+    int j;
+    for (j = dlx->left[node]; j != node; j = dlx->left[j]) {
+        uncover(dlx, dlx->column[j]);
+    }
+}
+
+/**
+ * Find the uncovered column with the fewest nodes, returning 0 (the root) if
+ * every column is covered.
+ */
+static int choose_column(const dlx_t* dlx) {
+    int best = 0;
+    int c;
+
+    for (c = dlx->right[0]; c != 0; c = dlx->right[c]) {
+        if (!best || dlx->size[c] < dlx->size[best]) {
+            best = c;
+            if (!dlx->size[c]) {
+                break;
+            }
+        }
+    }
+
+    return best;
+}
+
+/**
+ * Append a node to column `c`, returning its index.
+ */
+static int add_node(dlx_t* dlx, int c, int row) {
+    int node = dlx->node_count++;
+
+    dlx->column[node] = c;
+    dlx->row[node] = row;
+
+    dlx->up[node] = dlx->up[c];
+    dlx->down[node] = c;
+    dlx->down[dlx->up[c]] = node;
+    dlx->up[c] = node;
+    dlx->size[c]++;
+
+    return node;
+}
+
+/**
+ * Assign column headers to every constraint not yet satisfied by `board`,
+ * storing them to `headers` (indexed by constraint, 0 for satisfied
+ * constraints). Constraint `idx` is "cell `idx` holds a value", and constraint
+ * `cell_count + unit * block_size + value - 1` is "`unit` holds `value`".
+ */
+static void assign_headers(dlx_t* dlx, const board_t* board, int* headers) {
+    int block_size = board_block_size(board);
+    int cell_count = block_size * block_size;
+    int words = board->mask_words;
+    int idx, unit, value;
+
+    dlx->column_count = 0;
+
+    for (idx = 0; idx < cell_count; idx++) {
+        if (!board_get_value_at(board, idx)) {
+            headers[idx] = ++dlx->column_count;
+        }
+    }
+
+    for (unit = 0; unit < UK_COUNT * block_size; unit++) {
+        const bitset_word_t* placed = &board->unit_masks[unit * words];
+
+        for (value = 1; value <= block_size; value++) {
+            if (!BITSET_TEST(placed, value - 1)) {
+                headers[cell_count + unit * block_size + value - 1] =
+                    ++dlx->column_count;
+            }
+        }
+    }
+}
+
+void dlx_init(dlx_t* dlx, const board_t* board) {
+    int block_size = board_block_size(board);
+    int cell_count = block_size * block_size;
+    int* headers =
+        checked_calloc(cell_count + UK_COUNT * cell_count, sizeof(int));
+
+    board_candidates_t candidates;
+    int node_capacity;
+    int idx, c;
+
+    board_compute_all_candidates(board, &candidates);
+    assign_headers(dlx, board, headers);
+
+    dlx->row_count = 0;
+    dlx->max_depth = 0;
+    for (idx = 0; idx < cell_count; idx++) {
+        if (!board_get_value_at(board, idx)) {
+            dlx->row_count += bitset_count(
+                board_candidates_access_at(&candidates, idx), candidates.words);
+            dlx->max_depth++;
+        }
+    }
+
+    node_capacity = 1 + dlx->column_count + DLX_ROW_NODES * dlx->row_count;
+    dlx->left = checked_calloc(node_capacity, sizeof(int));
+    dlx->right = checked_calloc(node_capacity, sizeof(int));
+    dlx->up = checked_calloc(node_capacity, sizeof(int));
+    dlx->down = checked_calloc(node_capacity, sizeof(int));
+    dlx->column = checked_calloc(node_capacity, sizeof(int));
+    dlx->row = checked_calloc(node_capacity, sizeof(int));
+    dlx->size = checked_calloc(dlx->column_count + 1, sizeof(int));
+
+    dlx->row_cell = checked_calloc(dlx->row_count + 1, sizeof(int));
+    dlx->row_value = checked_calloc(dlx->row_count + 1, sizeof(int));
+    dlx->choices = checked_calloc(dlx->max_depth + 1, sizeof(int));
+
+    dlx->conflicted = board_has_conflicts(board);
+
+    /* Link the root and column headers into a ring, each header initially
+     * forming an empty vertical ring of its own. */
+    for (c = 0; c <= dlx->column_count; c++) {
+        dlx->left[c] = c == 0 ? dlx->column_count : c - 1;
+        dlx->right[c] = c == dlx->column_count ? 0 : c + 1;
+        dlx->up[c] = c;
+        dlx->down[c] = c;
+        dlx->column[c] = c;
+    }
+    dlx->node_count = dlx->column_count + 1;
+
+    dlx->row_count = 0;
+    for (idx = 0; idx < cell_count; idx++) {
+        const int* units = geometry_cell_units(board->geom, idx);
+        const bitset_word_t* set =
+            board_candidates_access_at(&candidates, idx);
+        int bit;
+
+        if (board_get_value_at(board, idx)) {
+            continue;
+        }
+
+        for (bit = bitset_next(set, candidates.words, 0); bit != -1;
+             bit = bitset_next(set, candidates.words, bit + 1)) {
+            int row = dlx->row_count++;
+            int nodes[DLX_ROW_NODES];
+            int kind, i;
+
+            dlx->row_cell[row] = idx;
+            dlx->row_value[row] = bit + 1;
+
+            nodes[0] = add_node(dlx, headers[idx], row);
+            for (kind = 0; kind < UK_COUNT; kind++) {
+                int constraint = cell_count + units[kind] * block_size + bit;
+                nodes[kind + 1] = add_node(dlx, headers[constraint], row);
+            }
+
+            for (i = 0; i < DLX_ROW_NODES; i++) {
+                dlx->left[nodes[i]] =
+                    nodes[(i + DLX_ROW_NODES - 1) % DLX_ROW_NODES];
+                dlx->right[nodes[i]] = nodes[(i + 1) % DLX_ROW_NODES];
+            }
+        }
+    }
+
+    board_candidates_destroy(&candidates);
+    free(headers);
+}
+
+void dlx_destroy(dlx_t* dlx) {
+    free(dlx->choices);
+    free(dlx->row_value);
+    free(dlx->row_cell);
+    free(dlx->size);
+    free(dlx->row);
+    free(dlx->column);
+    free(dlx->down);
+    free(dlx->up);
+    free(dlx->right);
+    free(dlx->left);
+}
+
+/**
+ * States of the iterative search loop.
+ */
+typedef enum {
+    DS_ENTER,     /* Choose a column at the current level */
+    DS_ADVANCE,   /* Try the current choice at the current level */
+    DS_BACKTRACK, /* Return to the previous level */
+    DS_STOP       /* Unwind every level and return */
+} dlx_state_t;
+
+/**
+ * Run Algorithm X, counting solutions until `limit` have been found (or
+ * indefinitely if `limit` is 0). If `solution` is not null, the first solution
+ * found is filled into it. The matrix is restored before returning.
+ */
+static long dlx_search(dlx_t* dlx, int limit, board_t* solution) {
+    dlx_state_t state = DS_ENTER;
+    int level = 0;
+    long count = 0;
+
+    if (dlx->conflicted) {
+        return 0;
+    }
+
+    while (state != DS_STOP) {
+        switch (state) {
+        case DS_ENTER: {
+            int c = choose_column(dlx);
+
+            if (c == 0) {
+                /* Every constraint is satisfied - record the solution. */
+                if (solution && !count) {
+                    int i;
+                    for (i = 0; i < level; i++) {
+                        int row = dlx->row[dlx->choices[i]];
+                        board_set_value_at(solution, dlx->row_cell[row],
+                                           dlx->row_value[row]);
+                    }
+                }
+
+                count++;
+                state = limit && count >= limit ? DS_STOP : DS_BACKTRACK;
+            } else if (!dlx->size[c]) {
+                state = DS_BACKTRACK;
+            } else {
+                cover(dlx, c);
+                dlx->choices[level] = dlx->down[c];
+                state = DS_ADVANCE;
+            }
+            break;
+        }
+
+        case DS_ADVANCE: {
+            int node = dlx->choices[level];
+
+            if (node == dlx->column[node]) {
+                /* We've wrapped around to the header: every row in this column
+                 * has been tried. */
+                uncover(dlx, node);
+                state = DS_BACKTRACK;
+            } else {
+                cover_row(dlx, node);
+                level++;
+                state = DS_ENTER;
+            }
+            break;
+        }
+
+        case DS_BACKTRACK:
+            if (level == 0) {
+                return count;
+            }
+
+            level--;
+            uncover_row(dlx, dlx->choices[level]);
+            dlx->choices[level] = dlx->down[dlx->choices[level]];
+            state = DS_ADVANCE;
+            break;
+
+        case DS_STOP:
+            break;
+        }
+    }
+
+    while (level > 0) {
+        int node = dlx->choices[--level];
+        uncover_row(dlx, node);
+        uncover(dlx, dlx->column[node]);
+    }
+
+    return count;
+}
+
+long dlx_count(dlx_t* dlx) { return dlx_search(dlx, 0, NULL); }
+
+bool_t dlx_solve(dlx_t* dlx, board_t* board) {
+    return dlx_search(dlx, 1, board) > 0;
+}
@@ -0,0 +1,66 @@
+/**
+ * dlx.h - Dancing links (Algorithm X) exact cover solver for boards.
+ */
+
+#ifndef DLX_H
+#define DLX_H
+
+#include "board.h"
+#include "bool.h"
+
+/**
+ * Exact cover matrix for a partially-filled board, stored as a toroidal
+ * doubly-linked list of nodes addressed by index.
+ *
+ * The matrix has a column for every constraint not already satisfied by the
+ * board's filled cells ("cell holds a value" and "unit holds value v" for every
+ * row, column and block), and a matrix row for every candidate of every empty
+ * cell. Node 0 is the root, and nodes `[1, column_count]` are column headers.
+ */
+typedef struct dlx {
+    int* left;
+    int* right;
+    int* up;
+    int* down;
+    int* column; /* Column header of every node */
+    int* size;   /* Number of nodes in every column (indexed by header) */
+    int* row;    /* Matrix row of every non-header node */
+
+    int column_count;
+    int node_count;
+
+    int* row_cell;  /* Board cell index of every matrix row */
+    int* row_value; /* Value placed by every matrix row */
+    int row_count;
+
+    int* choices; /* Node chosen at every search level */
+    int max_depth;
+
+    bool_t conflicted; /* True if the board had conflicting cells */
+} dlx_t;
+
+/**
+ * Build the exact cover matrix for the current contents of `board`. The board
+ * itself is not referenced after this function returns.
+ */
+void dlx_init(dlx_t* dlx, const board_t* board);
+
+/**
+ * Destroy `dlx`, releasing any allocated resources.
+ */
+void dlx_destroy(dlx_t* dlx);
+
+/**
+ * Count the solutions of the board the matrix was built from. Boards that
+ * already contain conflicts have no solutions.
+ */
+long dlx_count(dlx_t* dlx);
+
+/**
+ * Find the first solution of the board the matrix was built from, filling it
+ * into `board` (which should be the same board). Returns false, leaving
+ * `board` untouched, if there are no solutions.
+ */
+bool_t dlx_solve(dlx_t* dlx, board_t* board);
+
+#endif
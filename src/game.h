@@ -9,6 +9,7 @@
 #include "bool.h"
 #include "history.h"
 #include "lp.h"
+#include "search.h"
 
 typedef enum game_mode { GM_EDIT, GM_SOLVE, GM_INIT } game_mode_t;
 
@@ -18,6 +19,9 @@ typedef struct game {
     board_t board;
     history_t history;
     lp_env_t lp_env;
+    int thread_count; /* Worker threads used when counting solutions */
+    bool_t report_lp_stats; /* Print LP build/solve times after commands */
+    search_tt_t count_tt; /* Subproblem counts kept between solution counts */
 } game_t;
 
 #endif
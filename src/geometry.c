@@ -0,0 +1,195 @@
+#include "geometry.h"
+
+#include "bool.h"
+#include "checked_alloc.h"
+#include <stddef.h>
+#include <stdlib.h>
+
+/**
+ * Peer tables with more entries than this are not built, to keep memory usage
+ * reasonable on very large boards.
+ */
+#define GEOMETRY_MAX_PEER_ENTRIES (1 << 24)
+
+/**
+ * Head of the list of cached geometries.
+ */
+static geometry_t* geometry_cache = NULL;
+
+/**
+ * Fill the unit and per-cell unit tables of `geom`.
+ */
+static void build_units(geometry_t* geom) {
+    int block_size = geom->block_size;
+    int ctx, local_off;
+
+    for (ctx = 0; ctx < block_size; ctx++) {
+        int* row = &geom->units[(UK_ROW * block_size + ctx) * block_size];
+        int* col = &geom->units[(UK_COL * block_size + ctx) * block_size];
+        int* block = &geom->units[(UK_BLOCK * block_size + ctx) * block_size];
+
+        int block_row = ctx / geom->m;
+        int block_col = ctx % geom->m;
+
+        for (local_off = 0; local_off < block_size; local_off++) {
+            int local_row = local_off / geom->n;
+            int local_col = local_off % geom->n;
+
+            int cell_row = block_row * geom->m + local_row;
+            int cell_col = block_col * geom->n + local_col;
+
+            row[local_off] = geometry_cell_index(geom, ctx, local_off);
+            col[local_off] = geometry_cell_index(geom, local_off, ctx);
+            block[local_off] = geometry_cell_index(geom, cell_row, cell_col);
+        }
+    }
+
+    for (ctx = 0; ctx < UK_COUNT * block_size; ctx++) {
+        int kind = ctx / block_size;
+        int unit = ctx % block_size;
+
+        for (local_off = 0; local_off < block_size; local_off++) {
+            int idx = geom->units[ctx * block_size + local_off];
+            int step = (kind * block_size + local_off) * block_size + unit;
+
+            geom->cell_units[idx * UK_COUNT + kind] = ctx;
+            geom->unit_steps[step] = idx;
+        }
+    }
+}
+
+/**
+ * Fill the peer table of `geom`: row neighbors first, then column neighbors,
+ * then block neighbors sharing neither the row nor the column.
+ */
+static void build_peers(geometry_t* geom) {
+    int block_size = geom->block_size;
+    int idx;
+
+    for (idx = 0; idx < geom->cell_count; idx++) {
+        int* peers = &geom->peers[idx * geom->peer_count];
+        const int* units = &geom->cell_units[idx * UK_COUNT];
+
+        int count = 0;
+        int kind, i;
+
+        for (kind = 0; kind < UK_COUNT; kind++) {
+            const int* unit = &geom->units[units[kind] * block_size];
+
+            for (i = 0; i < block_size; i++) {
+                int peer = unit[i];
+                const int* peer_units = &geom->cell_units[peer * UK_COUNT];
+
+                bool_t shares_line = peer_units[UK_ROW] == units[UK_ROW] ||
+                                     peer_units[UK_COL] == units[UK_COL];
+
+                if (peer == idx || (kind == UK_BLOCK && shares_line)) {
+                    continue;
+                }
+
+                peers[count++] = peer;
+            }
+        }
+    }
+}
+
+/**
+ * Build the tables for a new geometry.
+ */
+static geometry_t* geometry_create(int m, int n, board_layout_t layout) {
+    geometry_t* geom = checked_malloc(sizeof(geometry_t));
+    int block_size = m * n;
+
+    geom->m = m;
+    geom->n = n;
+    geom->layout = layout;
+    geom->block_size = block_size;
+    geom->cell_count = block_size * block_size;
+
+    geom->units =
+        checked_calloc(UK_COUNT * block_size * block_size, sizeof(int));
+    geom->unit_steps =
+        checked_calloc(UK_COUNT * block_size * block_size, sizeof(int));
+    geom->cell_units = checked_calloc(UK_COUNT * geom->cell_count, sizeof(int));
+    build_units(geom);
+
+    geom->peer_count = 3 * block_size - m - n - 1;
+    if ((double)geom->peer_count * geom->cell_count <=
+        GEOMETRY_MAX_PEER_ENTRIES) {
+        geom->peers =
+            checked_calloc(geom->peer_count * geom->cell_count, sizeof(int));
+        build_peers(geom);
+    } else {
+        geom->peers = NULL;
+    }
+
+    geom->refcount = 0;
+    geom->next = NULL;
+
+    return geom;
+}
+
+const geometry_t* geometry_acquire(int m, int n, board_layout_t layout) {
+    geometry_t* geom;
+
+    for (geom = geometry_cache; geom; geom = geom->next) {
+        if (geom->m == m && geom->n == n && geom->layout == layout) {
+            break;
+        }
+    }
+
+    if (!geom) {
+        geom = geometry_create(m, n, layout);
+        geom->next = geometry_cache;
+        geometry_cache = geom;
+    }
+
+    geom->refcount++;
+    return geom;
+}
+
+void geometry_release(const geometry_t* geom) {
+    geometry_t** prev_ptr;
+
+    if (!geom) {
+        return;
+    }
+
+    for (prev_ptr = &geometry_cache; *prev_ptr; prev_ptr = &(*prev_ptr)->next) {
+        geometry_t* cur = *prev_ptr;
+
+        if (cur != geom) {
+            continue;
+        }
+
+        if (--cur->refcount == 0) {
+            *prev_ptr = cur->next;
+            free(cur->peers);
+            free(cur->cell_units);
+            free(cur->unit_steps);
+            free(cur->units);
+            free(cur);
+        }
+        return;
+    }
+}
+
+int geometry_cell_index(const geometry_t* geom, int row, int col) {
+    int block, local;
+
+    if (geom->layout == BL_ROW_MAJOR) {
+        return row * geom->block_size + col;
+    }
+
+    block = (row / geom->m) * geom->m + col / geom->n;
+    local = (row % geom->m) * geom->n + col % geom->n;
+    return block * geom->block_size + local;
+}
+
+const int* geometry_unit(const geometry_t* geom, int unit) {
+    return &geom->units[unit * geom->block_size];
+}
+
+const int* geometry_cell_units(const geometry_t* geom, int idx) {
+    return &geom->cell_units[idx * UK_COUNT];
+}
@@ -0,0 +1,90 @@
+/**
+ * geometry.h - Precomputed unit and peer tables for a given board geometry.
+ */
+
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+/**
+ * Kinds of units (groups of cells that may not share values). Unit `i` of kind
+ * `kind` has the global unit index `kind * block_size + i`.
+ */
+typedef enum unit_kind {
+    UK_ROW,
+    UK_COL,
+    UK_BLOCK,
+    UK_COUNT /* Number of unit kinds */
+} unit_kind_t;
+
+/**
+ * Orders in which cells can be laid out in a board's cell array.
+ */
+typedef enum board_layout {
+    BL_ROW_MAJOR,  /* Rows are contiguous */
+    BL_BLOCK_MAJOR /* Blocks are contiguous, and row-major internally */
+} board_layout_t;
+
+/**
+ * Index tables shared by all boards with the same `m`, `n` and layout. Cells
+ * are identified by their index in the board's cell array.
+ */
+typedef struct geometry {
+    int m;
+    int n;
+    board_layout_t layout;
+    int block_size;
+    int cell_count;
+
+    /* Cell indices of every unit, `block_size` entries per unit. Block cells
+     * are listed in row-major order. */
+    int* units;
+
+    /* The units of every kind transposed, for processing several units in
+     * lockstep: entry `(kind * block_size + step) * block_size + i` is the
+     * `step`-th cell of unit `i` of kind `kind`. */
+    int* unit_steps;
+
+    /* The `UK_COUNT` global unit indices of every cell. */
+    int* cell_units;
+
+    /* Indices of the cells sharing a unit with every cell, `peer_count` entries
+     * per cell. This is null for geometries too large to tabulate, in which
+     * case peers should be found by walking `units`. */
+    int peer_count;
+    int* peers;
+
+    int refcount;
+    struct geometry* next;
+} geometry_t;
+
+/**
+ * Retrieve the tables for the specified geometry, building them if they are not
+ * already cached. Every call should be balanced by a call to
+ * `geometry_release`.
+ *
+ * Note: the cache is not thread-safe.
+ */
+const geometry_t* geometry_acquire(int m, int n, board_layout_t layout);
+
+/**
+ * Release a reference obtained from `geometry_acquire`, freeing the tables once
+ * they are no longer used. This is a no-op if `geom` is null.
+ */
+void geometry_release(const geometry_t* geom);
+
+/**
+ * Compute the index of the cell at the specified row and column.
+ */
+int geometry_cell_index(const geometry_t* geom, int row, int col);
+
+/**
+ * Retrieve the cell indices of the specified (global) unit.
+ */
+const int* geometry_unit(const geometry_t* geom, int unit);
+
+/**
+ * Retrieve the `UK_COUNT` unit indices of the specified cell.
+ */
+const int* geometry_cell_units(const geometry_t* geom, int idx);
+
+#endif
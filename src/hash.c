@@ -0,0 +1,9 @@
+#include "hash.h"
+
+unsigned long hash_mix(unsigned long x) {
+    /* The shifts by 30 and 31 are split so that they stay in range when
+     * `unsigned long` is only 32 bits wide. */
+    x = (x ^ (x >> 15 >> 15)) * HASH_CONSTANT(0xbf58476dUL, 0x1ce4e5b9UL);
+    x = (x ^ (x >> 27)) * HASH_CONSTANT(0x94d049bbUL, 0x133111ebUL);
+    return x ^ (x >> 15 >> 16);
+}
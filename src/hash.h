@@ -0,0 +1,25 @@
+/**
+ * hash.h - Integer hashing helpers shared by board and canonical-form hashes.
+ */
+
+#ifndef HASH_H
+#define HASH_H
+
+/**
+ * Build a 64-bit constant from its 32-bit halves, keeping only the low half
+ * where `unsigned long` is narrower.
+ */
+#define HASH_CONSTANT(hi, lo)                                                  \
+    (((unsigned long)(hi) << 16 << 16) | (unsigned long)(lo))
+
+/**
+ * Golden-ratio increment used to seed SplitMix64 sequences.
+ */
+#define HASH_GOLDEN_GAMMA HASH_CONSTANT(0x9e3779b9UL, 0x7f4a7c15UL)
+
+/**
+ * Scramble `x` with the SplitMix64 finalizer.
+ */
+unsigned long hash_mix(unsigned long x);
+
+#endif
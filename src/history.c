@@ -41,14 +41,13 @@ void delta_list_apply(board_t* board, const delta_list_t* list,
                       delta_callback_t callback) {
     int i;
     for (i = 0; i < list->size; i++) {
-        cell_t* c =
-            board_access(board, list->deltas[i].row, list->deltas[i].col);
+        const delta_t* delta = &list->deltas[i];
+        int old_val = board_get_value(board, delta->row, delta->col);
 
-        c->value += list->deltas[i].diff;
+        board_set_value(board, delta->row, delta->col, old_val + delta->diff);
 
         if (callback) {
-            callback(list->deltas[i].row, list->deltas[i].col,
-                     c->value - list->deltas[i].diff, c->value);
+            callback(delta->row, delta->col, old_val, old_val + delta->diff);
         }
     }
 }
@@ -56,14 +55,17 @@ void delta_list_apply(board_t* board, const delta_list_t* list,
 void delta_list_set_diff(delta_list_t* list, const board_t* old,
                          const board_t* new) {
     int block_size = board_block_size(old);
-    int row, col;
+    int idx;
 
     delta_list_init(list);
 
-    for (row = 0; row < block_size; row++) {
-        for (col = 0; col < block_size; col++) {
-            int old_val = board_access_const(old, row, col)->value;
-            int new_val = board_access_const(new, row, col)->value;
+    for (idx = 0; idx < block_size * block_size; idx++) {
+        int old_val = board_get_value_at(old, idx);
+        int new_val = board_get_value_at(new, idx);
+
+        if (old_val != new_val) {
+            int row, col;
+            board_cell_position(old, idx, &row, &col);
             delta_list_add(list, row, col, old_val, new_val);
         }
     }
@@ -73,14 +75,13 @@ void delta_list_revert(board_t* board, const delta_list_t* list,
                        delta_callback_t callback) {
     int i;
     for (i = 0; i < list->size; i++) {
-        cell_t* c =
-            board_access(board, list->deltas[i].row, list->deltas[i].col);
+        const delta_t* delta = &list->deltas[i];
+        int old_val = board_get_value(board, delta->row, delta->col);
 
-        c->value -= list->deltas[i].diff;
+        board_set_value(board, delta->row, delta->col, old_val - delta->diff);
 
         if (callback) {
-            callback(list->deltas[i].row, list->deltas[i].col,
-                     c->value + list->deltas[i].diff, c->value);
+            callback(delta->row, delta->col, old_val, old_val - delta->diff);
         }
     }
 }
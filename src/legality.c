@@ -0,0 +1,201 @@
+#include "legality.h"
+
+#include <stddef.h>
+
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__LP64__)
+#define LEGALITY_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * Accumulate duplicates of a single unit, `cells` listing its cells.
+ */
+static bitset_word_t unit_duplicates(const int* cells, int block_size,
+                                     const bitset_word_t* onehot) {
+    bitset_word_t seen = 0;
+    bitset_word_t dup = 0;
+
+    int i;
+    for (i = 0; i < block_size; i++) {
+        bitset_word_t bit = onehot[cells[i]];
+        dup |= seen & bit;
+        seen |= bit;
+    }
+
+    return dup;
+}
+
+/**
+ * Scalar kernel: process units `[first, block_size)` of every kind, one at a
+ * time.
+ */
+static void find_duplicates_scalar(const geometry_t* geom,
+                                   const bitset_word_t* onehot,
+                                   bitset_word_t* dups, int first) {
+    int block_size = geom->block_size;
+    int kind, unit;
+
+    for (kind = 0; kind < UK_COUNT; kind++) {
+        for (unit = first; unit < block_size; unit++) {
+            int unit_idx = kind * block_size + unit;
+            dups[unit_idx] = unit_duplicates(geometry_unit(geom, unit_idx),
+                                             block_size, onehot);
+        }
+    }
+}
+
+#ifdef LEGALITY_X86
+
+/**
+ * SSE2 kernel: process units two at a time, returning the number of units of
+ * each kind processed. SSE2 lacks gathers, so cell words are loaded
+ * individually.
+ */
+static int find_duplicates_sse2(const geometry_t* geom,
+                                const bitset_word_t* onehot,
+                                bitset_word_t* dups) {
+    int block_size = geom->block_size;
+    int vec_units = block_size - block_size % 2;
+    int kind, unit, step;
+
+    for (kind = 0; kind < UK_COUNT; kind++) {
+        const int* steps = &geom->unit_steps[kind * block_size * block_size];
+
+        for (unit = 0; unit < vec_units; unit += 2) {
+            __m128i seen = _mm_setzero_si128();
+            __m128i dup = _mm_setzero_si128();
+
+            for (step = 0; step < block_size; step++) {
+                const int* cells = &steps[step * block_size + unit];
+                __m128i bits = _mm_set_epi64x(onehot[cells[1]],
+                                              onehot[cells[0]]);
+
+                dup = _mm_or_si128(dup, _mm_and_si128(seen, bits));
+                seen = _mm_or_si128(seen, bits);
+            }
+
+            _mm_storeu_si128((__m128i*)&dups[kind * block_size + unit], dup);
+        }
+    }
+
+    return vec_units;
+}
+
+/**
+ * AVX2 kernel: process units four at a time, gathering the cell words of every
+ * step in one instruction. Returns the number of units of each kind processed.
+ */
+__attribute__((target("avx2"))) static int
+find_duplicates_avx2(const geometry_t* geom, const bitset_word_t* onehot,
+                     bitset_word_t* dups) {
+    int block_size = geom->block_size;
+    int vec_units = block_size - block_size % 4;
+    int kind, unit, step;
+
+    for (kind = 0; kind < UK_COUNT; kind++) {
+        const int* steps = &geom->unit_steps[kind * block_size * block_size];
+
+        for (unit = 0; unit < vec_units; unit += 4) {
+            __m256i seen = _mm256_setzero_si256();
+            __m256i dup = _mm256_setzero_si256();
+
+            for (step = 0; step < block_size; step++) {
+                __m128i cells = _mm_loadu_si128(
+                    (const __m128i*)&steps[step * block_size + unit]);
+                __m256i bits =
+                    _mm256_i32gather_epi64((const void*)onehot, cells, 8);
+
+                dup = _mm256_or_si256(dup, _mm256_and_si256(seen, bits));
+                seen = _mm256_or_si256(seen, bits);
+            }
+
+            _mm256_storeu_si256((__m256i*)&dups[kind * block_size + unit],
+                                dup);
+        }
+    }
+
+    return vec_units;
+}
+
+#endif
+
+/**
+ * Whether the machine supports AVX2, and the fastest supported kernel, or -1
+ * before `legality_init` has run.
+ */
+static int has_avx2 = -1;
+static int best_kernel = -1;
+
+void legality_init(void) {
+    if (best_kernel != -1) {
+        return;
+    }
+
+#ifdef LEGALITY_X86
+    __builtin_cpu_init();
+    has_avx2 = __builtin_cpu_supports("avx2") != 0;
+#else
+    has_avx2 = 0;
+#endif
+
+    best_kernel = LK_COUNT - 1;
+    while (!legality_kernel_supported((legality_kernel_t)best_kernel)) {
+        best_kernel--;
+    }
+}
+
+bool_t legality_kernel_supported(legality_kernel_t kernel) {
+    switch (kernel) {
+    case LK_SCALAR:
+        return TRUE;
+#ifdef LEGALITY_X86
+    case LK_SSE2:
+        return TRUE; /* Part of the x86-64 baseline */
+    case LK_AVX2:
+        legality_init();
+        return has_avx2;
+#endif
+    default:
+        return FALSE;
+    }
+}
+
+legality_kernel_t legality_best_kernel(void) {
+    legality_init();
+    return (legality_kernel_t)best_kernel;
+}
+
+bool_t legality_find_duplicates(const geometry_t* geom,
+                                const bitset_word_t* onehot,
+                                bitset_word_t* dups, legality_kernel_t kernel) {
+    int processed = 0;
+    int i;
+
+    if (!legality_kernel_supported(kernel)) {
+        kernel = LK_SCALAR;
+    }
+
+    switch (kernel) {
+#ifdef LEGALITY_X86
+    case LK_SSE2:
+        processed = find_duplicates_sse2(geom, onehot, dups);
+        break;
+    case LK_AVX2:
+        processed = find_duplicates_avx2(geom, onehot, dups);
+        break;
+#endif
+    default:
+        break;
+    }
+
+    /* Pick up any units left over by the vector kernels. */
+    find_duplicates_scalar(geom, onehot, dups, processed);
+
+    for (i = 0; i < UK_COUNT * geom->block_size; i++) {
+        if (dups[i]) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
@@ -0,0 +1,66 @@
+/**
+ * legality.h - Vectorized duplicate detection across the units of a board.
+ */
+
+#ifndef LEGALITY_H
+#define LEGALITY_H
+
+#include "bitset.h"
+#include "bool.h"
+#include "geometry.h"
+
+/**
+ * Largest block size supported by the kernels: every cell value must fit in a
+ * single bitset word.
+ */
+#define LEGALITY_MAX_BLOCK_SIZE BITSET_WORD_BITS
+
+/**
+ * Available implementations of the duplicate detection kernel.
+ */
+typedef enum legality_kernel {
+    LK_SCALAR, /* One unit at a time */
+    LK_SSE2,   /* Two units per instruction (x86-64 only) */
+    LK_AVX2,   /* Four units per instruction (x86-64 with AVX2 only) */
+    LK_COUNT   /* Number of kernels */
+} legality_kernel_t;
+
+/**
+ * Detect the CPU features that decide which kernels can run, if this has not
+ * been done yet. Board initialization calls this, so that detection happens
+ * before any boards are shared between threads.
+ *
+ * Note: like the geometry cache, this is not thread-safe. Code using the
+ * kernels without initializing a board first should call it before starting
+ * threads.
+ */
+void legality_init(void);
+
+/**
+ * Check whether the specified kernel can run on this machine.
+ */
+bool_t legality_kernel_supported(legality_kernel_t kernel);
+
+/**
+ * Retrieve the fastest kernel supported by this machine (see
+ * `legality_init`).
+ */
+legality_kernel_t legality_best_kernel(void);
+
+/**
+ * Find the values occurring more than once in every unit of `geom`, whose block
+ * size must not exceed `LEGALITY_MAX_BLOCK_SIZE`.
+ *
+ * `onehot` should hold a word for every cell, with only bit `value - 1` set for
+ * cells holding `value` and no bits set for empty cells. On return, word `i` of
+ * `dups` (which should have room for `UK_COUNT * block_size` words) will have
+ * bit `value - 1` set if `value` is duplicated within (global) unit `i`.
+ *
+ * If `kernel` is not supported on this machine, the scalar kernel is used.
+ * Returns true if any duplicates were found.
+ */
+bool_t legality_find_duplicates(const geometry_t* geom,
+                                const bitset_word_t* onehot,
+                                bitset_word_t* dups, legality_kernel_t kernel);
+
+#endif
@@ -1,420 +1,211 @@
 #include "lp.h"
 
+#include "bitset.h"
 #include "board.h"
 #include "bool.h"
 #include "checked_alloc.h"
-#include <gurobi_c.h>
+#include "lp_backend.h"
+#include "lp_model.h"
+#include "search.h"
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #define GENERATE_MAX_ATTEMPTS 1000
 
-bool_t lp_env_create(lp_env_t* env) {
-    GRBenv* grb_env = NULL;
-
-    if (GRBloadenv(&grb_env, NULL)) {
-        return FALSE;
-    }
-
-    if (GRBsetintparam(grb_env, GRB_INT_PAR_OUTPUTFLAG, 0)) {
-        GRBfreeenv(grb_env);
-        return FALSE;
-    }
-
-    *env = (lp_env_t)grb_env;
-    return TRUE;
-}
-
-void lp_env_free(lp_env_t env) { GRBfreeenv((GRBenv*)env); }
+struct lp_env_impl {
+    const lp_backend_t* backend;
+    void* state;
+    bool_t presolve;
+    lp_stats_t stats;
+};
 
 /**
- * Access the specified part of the variable map, based on row, column and
- * (1-based) cell value. The variable map is used to track the relationship
- * between board cells (and their values) and Gurobi variables.
+ * Every available backend, in order of preference.
  */
-static int* var_map_access(int* var_map, int block_size, int row, int col,
-                           int val) {
-    return &var_map[block_size * (block_size * row + col) + val - 1];
-}
+static const lp_backend_t* const backends[] = {
+#ifdef HAVE_GUROBI
+    &lp_gurobi_backend,
+#endif
+    &lp_native_backend};
 
-/**
- * Set all entries of the specified variable map to -1, indicating no variable.
- */
-static void clear_var_map(int* var_map, int block_size) {
-    int i;
-    for (i = 0; i < block_size * block_size * block_size; i++) {
-        var_map[i] = -1;
-    }
-}
+#define BACKEND_COUNT ((int)(sizeof(backends) / sizeof(backends[0])))
 
 /**
- * Populate the variable map based on the specified board. Every entry of the
- * map will contain an index, or -1 if no variable is to be associated with the
- * corresponding cell value.
- * If an empty cell without candidates is found, false will be returned (the
- * board is unsolvable).
+ * Create an environment using `backend`, returning false if the backend fails
+ * to initialize.
  */
-static bool_t compute_var_map(int* var_map, int* var_count, board_t* board) {
-    bool_t ret = TRUE;
-
-    int block_size = board_block_size(board);
-    int row, col;
-    int count = 0;
+static bool_t env_create(lp_env_t* env, const lp_backend_t* backend) {
+    void* state;
 
-    int* candidates = checked_calloc(block_size, sizeof(int));
-
-    clear_var_map(var_map, board_block_size(board));
-
-    for (row = 0; row < block_size; row++) {
-        for (col = 0; col < block_size; col++) {
-            int candidate_count, i;
-
-            if (!cell_is_empty(board_access(board, row, col))) {
-                continue;
-            }
-
-            candidate_count =
-                board_gather_candidates(board, row, col, candidates);
-
-            if (!candidate_count) {
-                ret = FALSE;
-                goto cleanup;
-            }
-
-            for (i = 0; i < candidate_count; i++) {
-                int val = candidates[i];
-                *var_map_access(var_map, block_size, row, col, val) = count++;
-            }
-        }
+    if (!backend->create(&state)) {
+        return FALSE;
     }
 
-    *var_count = count;
-
-cleanup:
-    free(candidates);
-    return ret;
+    *env = checked_malloc(sizeof(struct lp_env_impl));
+    (*env)->backend = backend;
+    (*env)->state = state;
+    (*env)->presolve = TRUE;
+    lp_env_reset_stats(*env);
+    return TRUE;
 }
 
-/**
- * Count the number of candidates for the specified position, based on
- * `var_map`.
- */
-static int count_candidates(int* var_map, int block_size, int row, int col) {
-    int count = 0;
+bool_t lp_env_create(lp_env_t* env) {
+    const char* name = getenv("SUDOKU_LP_BACKEND");
+    int i;
+
+    if (name) {
+        return lp_env_create_backend(env, name);
+    }
 
-    int val;
-    for (val = 1; val <= block_size; val++) {
-        if (*var_map_access(var_map, block_size, row, col, val) != -1) {
-            count++;
+    for (i = 0; i < BACKEND_COUNT; i++) {
+        if (env_create(env, backends[i])) {
+            return TRUE;
         }
     }
 
-    return count;
+    return FALSE;
 }
 
-/*
- * Abstraction for a function that can retrieve a value from the variable map
- * based on three indices (two "contexts" and one "local offset", all in the
- * range `[0, board_size)`). This is used go generalize constraint computation
- * for cells, rows, columns and blocks.
- */
-typedef int (*var_map_retriever_t)(const board_t* board, int* var_map, int ctx1,
-                                   int ctx2, int local_off);
-
-/**
- * Add constraints to the model based on variable indices found in the variable
- * map. For every values of `ctx1`, `ctx2` in `[0, block_size)`, `local_off` is
- * iterated through `[0, block_size)` as well, and all variable indices found
- * within a specific context are added as a constraint to the model.
- *
- * `indices` will be used as scratch space for the operation and should have
- * room for `block_size` entries.
- *
- * `coeffs` are the actual coefficients that will be provided to the
- * constraints, and should contain `block_size` entries. They are provided
- * externally to avoid repeated reallocation acrosss multiple `add_constraints`
- * calls.
- */
-static lp_status_t add_constraints(GRBmodel* model, const board_t* board,
-                                   int* var_map, var_map_retriever_t retrieve,
-                                   int* indices, double* coeffs) {
-    int block_size = board_block_size(board);
-    int ctx1, ctx2;
-
-    for (ctx1 = 0; ctx1 < block_size; ctx1++) {
-        for (ctx2 = 0; ctx2 < block_size; ctx2++) {
-            int numnz = 0;
-
-            int local_off;
-            for (local_off = 0; local_off < block_size; local_off++) {
-                int var_idx = retrieve(board, var_map, ctx1, ctx2, local_off);
-                if (var_idx != -1) {
-                    indices[numnz++] = var_idx;
-                }
-            }
+bool_t lp_env_create_backend(lp_env_t* env, const char* name) {
+    int i;
 
-            if (numnz) {
-                if (GRBaddconstr(model, numnz, indices, coeffs, GRB_EQUAL, 1.0,
-                                 NULL)) {
-                    return LP_GUROBI_ERR;
-                }
-            }
+    for (i = 0; i < BACKEND_COUNT; i++) {
+        if (!strcmp(backends[i]->name, name)) {
+            return env_create(env, backends[i]);
         }
     }
 
-    return LP_SUCCESS;
+    return FALSE;
 }
 
-/**
- * Retriever for adding cell constraints - local offset enumerates cell values.
- */
-static int retrieve_by_cell(const board_t* board, int* var_map, int ctx1,
-                            int ctx2, int local_off) {
-    return *var_map_access(var_map, board_block_size(board), ctx1, ctx2,
-                           local_off + 1);
+void lp_env_free(lp_env_t env) {
+    env->backend->destroy(env->state);
+    free(env);
 }
 
-/**
- * Retriever for adding row constraints - local offset enumerates columns.
- */
-static int retrieve_by_row(const board_t* board, int* var_map, int ctx1,
-                           int ctx2, int local_off) {
-    return *var_map_access(var_map, board_block_size(board), ctx1, local_off,
-                           ctx2 + 1);
-}
+const char* lp_env_backend_name(lp_env_t env) { return env->backend->name; }
 
-/**
- * Retriever for adding column constraints - local offset enumerates rows.
- */
-static int retrieve_by_col(const board_t* board, int* var_map, int ctx1,
-                           int ctx2, int local_off) {
-    return *var_map_access(var_map, board_block_size(board), local_off, ctx1,
-                           ctx2 + 1);
+void lp_env_set_presolve(lp_env_t env, bool_t presolve) {
+    env->presolve = presolve;
 }
 
-/**
- * Retriever for adding block constraints - local offset enumerates index within
- * block.
- */
-static int retrieve_by_block(const board_t* board, int* var_map, int ctx1,
-                             int ctx2, int local_off) {
-    int block_row = ctx1 / board->m;
-    int block_col = ctx1 % board->m;
-
-    int local_row = local_off / board->n;
-    int local_col = local_off % board->n;
-
-    int row = board_block_row(board, block_row, local_row);
-    int col = board_block_col(board, block_col, local_col);
+void lp_env_stats(lp_env_t env, lp_stats_t* stats) { *stats = env->stats; }
 
-    return *var_map_access(var_map, board_block_size(board), row, col,
-                           ctx2 + 1);
+void lp_env_reset_stats(lp_env_t env) {
+    memset(&env->stats, 0, sizeof(lp_stats_t));
 }
 
-static void fill_coeffs(double* coeffs, int block_size) {
-    int i;
-    for (i = 0; i < block_size; i++) {
-        coeffs[i] = 1.0;
-    }
+void lp_stats_add_time(double* total, clock_t start) {
+    *total += (double)(clock() - start) / CLOCKS_PER_SEC;
 }
 
+/* Presolve */
+
 /**
- * Add constraints guaranteeing board validity to `model`, based on `board` and
- * the pre-computed `var_map`.
+ * Fill in every cell of `board` forced by naked and hidden singles, returning
+ * false if propagation finds a contradiction. Boards that already contain
+ * conflicts are left for the backend, which decides whether they are feasible
+ * as before.
  */
-static lp_status_t add_board_constraints(GRBmodel* model, const board_t* board,
-                                         int* var_map) {
-    lp_status_t ret = LP_SUCCESS;
+static bool_t presolve(board_t* board, lp_stats_t* stats) {
+    bool_t ret = TRUE;
 
     int block_size = board_block_size(board);
+    search_t search;
+    int best;
+    int idx;
 
-    int* indices = checked_calloc(block_size, sizeof(int));
-    double* coeffs = checked_calloc(block_size, sizeof(double));
+    search_init(&search, board);
 
-    fill_coeffs(coeffs, block_size);
-
-    ret = add_constraints(model, board, var_map, retrieve_by_cell, indices,
-                          coeffs);
-    if (ret != LP_SUCCESS) {
+    if (search.conflicted) {
         goto cleanup;
     }
 
-    ret = add_constraints(model, board, var_map, retrieve_by_row, indices,
-                          coeffs);
-    if (ret != LP_SUCCESS) {
+    if (!search_propagate(&search, &best)) {
+        ret = FALSE;
         goto cleanup;
     }
 
-    ret = add_constraints(model, board, var_map, retrieve_by_col, indices,
-                          coeffs);
-    if (ret != LP_SUCCESS) {
-        goto cleanup;
+    for (idx = 0; idx < block_size * block_size; idx++) {
+        if (!board_get_value_at(board, idx) && search.values[idx]) {
+            board_set_value_at(board, idx, search.values[idx]);
+            stats->fixed_cells++;
+        }
     }
 
-    ret = add_constraints(model, board, var_map, retrieve_by_block, indices,
-                          coeffs);
-
 cleanup:
-    free(coeffs);
-    free(indices);
+    search_destroy(&search);
     return ret;
 }
 
 /**
- * Add variables of the specified type to `model` based on `var_map`,
- * constraining them to `[0, 1]`. The objective function will be set to favor
- * placing values in cells with fewer candidates, which has the effect of making
- * the model more "confident" about values in cells with few candidates.
- */
-static lp_status_t add_vars(GRBmodel* model, int block_size, int* var_map,
-                            char var_type) {
-    int row;
-    int col;
-
-    for (row = 0; row < block_size; row++) {
-        for (col = 0; col < block_size; col++) {
-            int candidate_count =
-                count_candidates(var_map, block_size, row, col);
-
-            int i;
-            for (i = 0; i < candidate_count; i++) {
-                /* Weight each variable for this cell with `candidate_count` in
-                 * the objective function, which, as we are minimizing, will
-                 * cause Gurobi to favor cells with fewer candidates. */
-                if (GRBaddvar(model, 0, NULL, NULL, candidate_count, 0.0, 1.0,
-                              var_type, NULL)) {
-                    return LP_GUROBI_ERR;
-                }
-            }
-        }
-    }
-
-    if (GRBsetintattr(model, GRB_INT_ATTR_MODELSENSE, GRB_MINIMIZE)) {
-        return LP_GUROBI_ERR;
-    }
-
-    if (GRBupdatemodel(model)) {
-        return LP_GUROBI_ERR;
-    }
-
-    return LP_SUCCESS;
-}
-
-/**
- * Callback invoked with nonzero LP values on success.
- */
-typedef void (*lp_val_callback_t)(int block_size, int row, int col, int val,
-                                  double score, void* ctx);
-
-/**
- * Create a new sudoku model in the specified environment.
- */
-static bool_t create_model(lp_env_t env, GRBmodel** model) {
-    return !GRBnewmodel((GRBenv*)env, model, "sudoku", 0, NULL, NULL, NULL,
-                        NULL, NULL);
-}
-
-/**
- * Report nonzero variable values from `model` to `callback`.
+ * Report the cells filled in by presolve, present in `presolved` but not in
+ * `board`, to `callback`.
  */
-static lp_status_t report_var_values(GRBmodel* model, int block_size,
-                                     int* var_map, int var_count,
-                                     lp_val_callback_t callback,
-                                     void* callback_ctx) {
-    lp_status_t ret = LP_SUCCESS;
+static void report_fixed_cells(const board_t* board, const board_t* presolved,
+                               lp_val_callback_t callback, void* callback_ctx) {
+    int block_size = board_block_size(board);
+    int idx;
 
-    double* var_values = checked_calloc(var_count, sizeof(double));
-    int row, col, val;
+    for (idx = 0; idx < block_size * block_size; idx++) {
+        int val = board_get_value_at(presolved, idx);
 
-    if (GRBgetdblattrarray(model, GRB_DBL_ATTR_X, 0, var_count, var_values)) {
-        ret = LP_GUROBI_ERR;
-        goto cleanup;
-    }
-
-    for (row = 0; row < block_size; row++) {
-        for (col = 0; col < block_size; col++) {
-            for (val = 1; val <= block_size; val++) {
-                int var_idx =
-                    *var_map_access(var_map, block_size, row, col, val);
-
-                if (var_idx != -1) {
-                    double score = var_values[var_idx];
-                    if (score > 0.0) {
-                        callback(block_size, row, col, val, score,
-                                 callback_ctx);
-                    }
-                }
-            }
+        if (!board_get_value_at(board, idx) && val) {
+            int row, col;
+            board_cell_position(board, idx, &row, &col);
+            callback(block_size, row, col, val, 1.0, callback_ctx);
         }
     }
-
-cleanup:
-    free(var_values);
-    return ret;
 }
 
 /**
- * Solve `board` using LP with the specified variable types, reporting
- * values to `callback` on success.
+ * Solve `board` with the environment's backend, using variables of the
+ * specified type and reporting values to `callback` on success. The board is
+ * presolved first if presolve is enabled.
  */
-static lp_status_t lp_solve(lp_env_t env, board_t* board, char var_type,
-                            lp_val_callback_t callback, void* callback_ctx) {
-    lp_status_t ret = LP_SUCCESS;
-
-    int block_size = board_block_size(board);
+static lp_status_t lp_solve(lp_env_t env, board_t* board,
+                            lp_var_type_t var_type, lp_val_callback_t callback,
+                            void* callback_ctx) {
+    lp_status_t ret;
 
-    GRBmodel* model = NULL;
-    int* var_map;
-    int var_count;
+    board_t presolved;
+    int var_count, constr_count;
+    int presolved_var_count, presolved_constr_count;
+    clock_t start;
 
-    int optim_status;
+    env->stats.solves++;
 
-    if (!create_model(env, &model)) {
-        return LP_GUROBI_ERR;
+    if (!env->presolve) {
+        return env->backend->solve(env->state, board, var_type, callback,
+                                   callback_ctx, &env->stats);
     }
 
-    var_map =
-        checked_malloc(block_size * block_size * block_size * sizeof(int));
+    start = clock();
+    board_clone(&presolved, board);
 
-    if (!compute_var_map(var_map, &var_count, board)) {
+    if (!presolve(&presolved, &env->stats)) {
+        lp_stats_add_time(&env->stats.presolve_time, start);
+        env->stats.presolve_infeasible++;
         ret = LP_INFEASIBLE;
         goto cleanup;
     }
 
-    ret = add_vars(model, block_size, var_map, var_type);
-    if (ret != LP_SUCCESS) {
-        goto cleanup;
-    }
+    lp_model_size(board, &var_count, &constr_count);
+    lp_model_size(&presolved, &presolved_var_count, &presolved_constr_count);
+    env->stats.removed_vars += var_count - presolved_var_count;
+    env->stats.removed_constrs += constr_count - presolved_constr_count;
+    lp_stats_add_time(&env->stats.presolve_time, start);
 
-    ret = add_board_constraints(model, board, var_map);
-    if (ret != LP_SUCCESS) {
-        goto cleanup;
-    }
-
-    if (GRBoptimize(model)) {
-        ret = LP_GUROBI_ERR;
-        goto cleanup;
-    }
-
-    if (GRBgetintattr(model, GRB_INT_ATTR_STATUS, &optim_status)) {
-        ret = LP_GUROBI_ERR;
-        goto cleanup;
-    }
-
-    if (optim_status == GRB_OPTIMAL) {
-        ret = report_var_values(model, block_size, var_map, var_count, callback,
-                                callback_ctx);
-    } else if (optim_status == GRB_INFEASIBLE ||
-               optim_status == GRB_INF_OR_UNBD) {
-        ret = LP_INFEASIBLE;
-    } else {
-        ret = LP_GUROBI_ERR;
+    ret = env->backend->solve(env->state, &presolved, var_type, callback,
+                              callback_ctx, &env->stats);
+    if (ret == LP_SUCCESS) {
+        report_fixed_cells(board, &presolved, callback, callback_ctx);
     }
 
 cleanup:
-    free(var_map);
-    GRBfreemodel(model);
+    board_destroy(&presolved);
     return ret;
 }
 
@@ -434,7 +225,7 @@ static void ilp_validate_callback(int block_size, int row, int col, int val,
 }
 
 lp_status_t lp_validate_ilp(lp_env_t env, board_t* board) {
-    return lp_solve(env, board, GRB_BINARY, ilp_validate_callback, NULL);
+    return lp_solve(env, board, LP_VAR_BINARY, ilp_validate_callback, NULL);
 }
 
 /**
@@ -446,11 +237,11 @@ static void ilp_solve_callback(int block_size, int row, int col, int val,
 
     (void)block_size;
     (void)score;
-    board_access(board, row, col)->value = val;
+    board_set_value(board, row, col, val);
 }
 
 lp_status_t lp_solve_ilp(lp_env_t env, board_t* board) {
-    return lp_solve(env, board, GRB_BINARY, ilp_solve_callback, board);
+    return lp_solve(env, board, LP_VAR_BINARY, ilp_solve_callback, board);
 }
 
 /* Puzzle Generation */
@@ -466,7 +257,7 @@ static int get_empty_cells(const board_t* board, int* cell_indices) {
 
     int cell_idx;
     for (cell_idx = 0; cell_idx < block_size * block_size; cell_idx++) {
-        if (cell_is_empty(&board->cells[cell_idx])) {
+        if (!board_get_value_at(board, cell_idx)) {
             cell_indices[count++] = cell_idx;
         }
     }
@@ -497,16 +288,18 @@ static bool_t set_random_candidate(board_t* board, int idx) {
     int block_size = board_block_size(board);
     int* candidates = checked_calloc(block_size, sizeof(int));
 
-    int row = idx / block_size;
-    int col = idx % block_size;
+    int row, col;
+    int candidate_count;
+
+    board_cell_position(board, idx, &row, &col);
 
-    int candidate_count = board_gather_candidates(board, row, col, candidates);
+    candidate_count = board_gather_candidates(board, row, col, candidates);
     if (!candidate_count) {
         ret = FALSE;
         goto cleanup;
     }
 
-    board->cells[idx].value = candidates[rand() % candidate_count];
+    board_set_value(board, row, col, candidates[rand() % candidate_count]);
 
 cleanup:
     free(candidates);
@@ -549,7 +342,7 @@ static void clear_random_cells(board_t* board, int count) {
     shuffle(cell_indices, board_size);
 
     for (i = 0; i < count; i++) {
-        board->cells[cell_indices[i]].value = 0;
+        board_set_value_at(board, cell_indices[i], 0);
     }
 
     free(cell_indices);
@@ -573,13 +366,12 @@ lp_gen_status_t lp_gen_ilp(lp_env_t env, board_t* board, int add, int leave) {
         goto cleanup_cell_indices;
     }
 
-    board_init(&tmp, board->m, board->n);
+    board_init_layout(&tmp, board->m, board->n, board_get_layout(board));
 
     for (iter = 0; iter < GEN_MAX_ATTEMPTS; iter++) {
         lp_status_t attempt_status;
 
-        memcpy(tmp.cells, board->cells,
-               block_size * block_size * sizeof(cell_t));
+        board_assign(&tmp, board);
 
         attempt_status =
             try_do_gen(env, &tmp, empty_cell_indices, empty_cell_count, add);
@@ -595,7 +387,7 @@ lp_gen_status_t lp_gen_ilp(lp_env_t env, board_t* board, int add, int leave) {
         }
     }
 
-    memcpy(board->cells, tmp.cells, block_size * block_size * sizeof(cell_t));
+    board_assign(board, &tmp);
     clear_random_cells(board, block_size * block_size - leave);
 
 cleanup_tmp:
@@ -657,31 +449,17 @@ lp_status_t lp_solve_continuous(lp_env_t env, board_t* board,
     memset(candidate_board, 0,
            sizeof(lp_cell_candidates_t) * block_size * block_size);
 
-    return lp_solve(env, board, GRB_CONTINUOUS, continuous_val_callback,
+    return lp_solve(env, board, LP_VAR_CONTINUOUS, continuous_val_callback,
                     candidate_board);
 }
 
-/**
- * Check whether `val` is legal for `cell`.
- */
-static bool_t is_value_legal(board_t* board, cell_t* cell, int val) {
-    int old_val = cell->value;
-    bool_t ret;
-
-    cell->value = val;
-    ret = board_is_legal(board);
-    cell->value = old_val;
-
-    return ret;
-}
-
 /**
  * Select a random, legal candidate from `candidates` whose score is at
  * least `thresh`. The probability of each candidate being drawn is
  * proportional to its score.
  */
 static lp_candidate_t* random_select(lp_cell_candidates_t* candidates,
-                                     board_t* board, cell_t* cell,
+                                     const board_t* board, int row, int col,
                                      double thresh) {
     lp_candidate_t* ret = NULL;
 
@@ -707,7 +485,8 @@ static lp_candidate_t* random_select(lp_cell_candidates_t* candidates,
     for (; i < candidates->size; i++) {
         lp_candidate_t* can = &candidates->candidates[i];
 
-        if (can->score < thresh || !is_value_legal(board, cell, can->val)) {
+        if (can->score < thresh ||
+            !board_is_legal_placement(board, row, col, can->val)) {
             continue;
         }
 
@@ -763,9 +542,9 @@ lp_status_t lp_guess_continuous(lp_env_t env, board_t* board, double thresh) {
         for (col = 0; col < block_size; col++) {
             lp_candidate_t* can =
                 random_select(&candidate_board[row * block_size + col], board,
-                              board_access(board, row, col), thresh);
+                              row, col, thresh);
             if (can) {
-                board_access(board, row, col)->value = can->val;
+                board_set_value(board, row, col, can->val);
             }
         }
     }
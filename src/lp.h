@@ -19,7 +19,7 @@ typedef struct lp_env_impl* lp_env_t;
 typedef enum lp_status {
     LP_SUCCESS,    /* Solving succeeded */
     LP_INFEASIBLE, /* Board is infeasible */
-    LP_GUROBI_ERR  /* Internal gurobi error */
+    LP_GUROBI_ERR  /* Internal solver error */
 } lp_status_t;
 
 /**
@@ -30,7 +30,7 @@ typedef enum lp_gen_status {
     GEN_TOO_FEW_EMPTY, /* To few cells on the board were empty */
     GEN_MAX_ATTEMPTS,  /* The generator was unable to generate a puzzle after
                              1000 attempts */
-    GEN_GUROBI_ERR     /* Internal gurobi error */
+    GEN_GUROBI_ERR     /* Internal solver error */
 } lp_gen_status_t;
 
 /**
@@ -51,15 +51,65 @@ typedef struct lp_cell_candidates {
 } lp_cell_candidates_t;
 
 /**
- * Initialize a new linear programming environment.
+ * Statistics accumulated by a linear programming environment.
+ */
+typedef struct lp_stats {
+    int solves;           /* Number of models solved */
+    double presolve_time; /* Processor time spent in presolve, in seconds */
+    double build_time;    /* Processor time spent building models, in seconds */
+    double solve_time;    /* Processor time spent solving models, in seconds */
+
+    int presolve_infeasible; /* Models found infeasible by presolve */
+    int fixed_cells;         /* Cells filled in by presolve */
+    int removed_vars;        /* Variables removed by presolve */
+    int removed_constrs;     /* Constraints removed by presolve */
+} lp_stats_t;
+
+/**
+ * Initialize a new linear programming environment, using the backend named by
+ * the `SUDOKU_LP_BACKEND` environment variable if it is set, or else the first
+ * backend that initializes successfully: Gurobi (when built with it), then
+ * the built-in exact solver.
  */
 bool_t lp_env_create(lp_env_t* env);
 
+/**
+ * Initialize a new linear programming environment using the backend named
+ * `name` ("gurobi" or "native"). Returns false if no such backend was built or
+ * it fails to initialize.
+ */
+bool_t lp_env_create_backend(lp_env_t* env, const char* name);
+
 /**
  * Destroy a linear programming environment.
  */
 void lp_env_free(lp_env_t env);
 
+/**
+ * Get the name of the backend used by `env`.
+ */
+const char* lp_env_backend_name(lp_env_t env);
+
+/**
+ * Enable or disable presolve in `env` (it is enabled by default). Before a
+ * model is built, presolve fills in every cell forced by naked and hidden
+ * singles, and reports infeasibility directly if this leads to a
+ * contradiction. Forced cells are reported with a score of 1, as the solver
+ * would report them.
+ */
+void lp_env_set_presolve(lp_env_t env, bool_t presolve);
+
+/**
+ * Get the statistics accumulated by `env` since it was created or its
+ * statistics were last reset.
+ */
+void lp_env_stats(lp_env_t env, lp_stats_t* stats);
+
+/**
+ * Reset the statistics accumulated by `env`.
+ */
+void lp_env_reset_stats(lp_env_t env);
+
 /**
  * Validate `board` using ILP.
  *
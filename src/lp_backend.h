@@ -0,0 +1,74 @@
+/**
+ * lp_backend.h - Solver backends behind linear programming environments.
+ */
+
+#ifndef LP_BACKEND_H
+#define LP_BACKEND_H
+
+#include "board.h"
+#include "bool.h"
+#include "lp.h"
+#include <time.h>
+
+/**
+ * Types of the variables of a model: one variable per candidate value of every
+ * empty cell.
+ */
+typedef enum lp_var_type {
+    LP_VAR_BINARY,    /* Variables take values in {0, 1} (ILP) */
+    LP_VAR_CONTINUOUS /* Variables take values in [0, 1] (LP) */
+} lp_var_type_t;
+
+/**
+ * Callback invoked with nonzero variable values on success.
+ */
+typedef void (*lp_val_callback_t)(int block_size, int row, int col, int val,
+                                  double score, void* ctx);
+
+/**
+ * A solver backend. Every backend solves the same model: every empty cell holds
+ * exactly one of its candidates, and every value missing from a row, column or
+ * block appears in exactly one of its empty cells.
+ */
+typedef struct lp_backend {
+    const char* name;
+
+    /**
+     * Create the backend's state in `*state`, returning false on failure.
+     */
+    bool_t (*create)(void** state);
+
+    /**
+     * Destroy state created by `create`.
+     */
+    void (*destroy)(void* state);
+
+    /**
+     * Solve the model for `board` with variables of type `var_type`, reporting
+     * nonzero values to `callback` on success. Time spent building and solving
+     * the model is added to `stats`.
+     */
+    lp_status_t (*solve)(void* state, board_t* board, lp_var_type_t var_type,
+                         lp_val_callback_t callback, void* callback_ctx,
+                         lp_stats_t* stats);
+} lp_backend_t;
+
+/**
+ * Add the processor time elapsed since `start` to `*total`, in seconds.
+ */
+void lp_stats_add_time(double* total, clock_t start);
+
+#ifdef HAVE_GUROBI
+/**
+ * Backend building the model in Gurobi.
+ */
+extern const lp_backend_t lp_gurobi_backend;
+#endif
+
+/**
+ * Built-in backend solving the integer model by exact cover search and the
+ * continuous model with the simplex method.
+ */
+extern const lp_backend_t lp_native_backend;
+
+#endif
@@ -0,0 +1,497 @@
+#include "lp_backend.h"
+
+#include "board.h"
+#include "bool.h"
+#include "checked_alloc.h"
+#include "lp_model.h"
+#include <gurobi_c.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * Maximum number of live models kept at once, one per board geometry.
+ */
+#define GUROBI_MAX_LIVE_MODELS 4
+
+/**
+ * Largest block size for which boards are solved through live models. A live
+ * model holds a variable for every value of every cell, so larger boards are
+ * instead solved with a model of their candidates built for each solve.
+ */
+#define GUROBI_MAX_LIVE_BLOCK_SIZE 25
+
+/**
+ * A live Gurobi model of one board geometry, built once from the geometry's
+ * template and restricted in place to each new board by updating only the
+ * bounds, right-hand sides and objective coefficients that changed. Its memory
+ * grows with the cube of the block size, as does the time to restrict it.
+ */
+typedef struct gurobi_live {
+    const lp_model_t* template; /* Owned by the backend's template cache */
+    GRBmodel* model;
+
+    /* Attribute values currently loaded into the model. */
+    char var_type;
+    double* ub;
+    double* rhs;
+    double* obj;
+
+    /* Scratch space for new attribute values and for changed entries. */
+    double* next_ub;
+    double* next_rhs;
+    double* next_obj;
+    int* changed_ind;
+    double* changed_vals;
+
+    /* Solution of the last integer solve, used as a MIP start. */
+    double* x;
+    bool_t has_start;
+
+    struct gurobi_live* next;
+} gurobi_live_t;
+
+/**
+ * Backend state: the Gurobi environment, the templates of every geometry seen
+ * so far and the live models of the most recently solved geometries.
+ */
+typedef struct gurobi_state {
+    GRBenv* env;
+    lp_template_cache_t templates;
+    gurobi_live_t* live; /* Most recently used first */
+} gurobi_state_t;
+
+static bool_t gurobi_create(void** state) {
+    gurobi_state_t* grb_state;
+    GRBenv* grb_env = NULL;
+
+    if (GRBloadenv(&grb_env, NULL)) {
+        return FALSE;
+    }
+
+    if (GRBsetintparam(grb_env, GRB_INT_PAR_OUTPUTFLAG, 0)) {
+        GRBfreeenv(grb_env);
+        return FALSE;
+    }
+
+    grb_state = checked_malloc(sizeof(gurobi_state_t));
+    grb_state->env = grb_env;
+    lp_template_cache_init(&grb_state->templates);
+    grb_state->live = NULL;
+
+    *state = grb_state;
+    return TRUE;
+}
+
+/**
+ * Free `live` along with its model.
+ */
+static void live_free(gurobi_live_t* live) {
+    GRBfreemodel(live->model);
+
+    free(live->x);
+    free(live->changed_vals);
+    free(live->changed_ind);
+    free(live->next_obj);
+    free(live->next_rhs);
+    free(live->next_ub);
+    free(live->obj);
+    free(live->rhs);
+    free(live->ub);
+    free(live);
+}
+
+/**
+ * Remove `live` from the live models of `state` and free it, so that the next
+ * solve of its geometry rebuilds it.
+ */
+static void discard_live(gurobi_state_t* state, gurobi_live_t* live) {
+    gurobi_live_t** prev_ptr;
+
+    for (prev_ptr = &state->live; *prev_ptr; prev_ptr = &(*prev_ptr)->next) {
+        if (*prev_ptr == live) {
+            *prev_ptr = live->next;
+            live_free(live);
+            return;
+        }
+    }
+}
+
+static void gurobi_destroy(void* state) {
+    gurobi_state_t* grb_state = state;
+
+    while (grb_state->live) {
+        discard_live(grb_state, grb_state->live);
+    }
+
+    lp_template_cache_destroy(&grb_state->templates);
+    GRBfreeenv(grb_state->env);
+    free(grb_state);
+}
+
+/**
+ * Load `lp_model` into a new Gurobi model in `*model`, with variables of type
+ * `var_type` constrained to `[0, 1]`. All variables are created by a single
+ * call, and all constraints by another, from the model's sparse rows.
+ *
+ * The objective function will favor placing values in cells with fewer
+ * candidates, which has the effect of making the model more "confident" about
+ * values in cells with few candidates.
+ */
+static lp_status_t load_model(GRBenv* env, GRBmodel** model,
+                              const lp_model_t* lp_model, char var_type) {
+    lp_status_t ret = LP_SUCCESS;
+
+    int var_count = lp_model->var_count;
+    int constr_count = lp_model->constr_count;
+    int numnz = lp_model->constr_start[constr_count];
+
+    double* ub = checked_calloc(var_count + 1, sizeof(double));
+    char* vtype = checked_calloc(var_count + 1, sizeof(char));
+    double* coeffs = checked_calloc(numnz + 1, sizeof(double));
+    char* sense = checked_calloc(constr_count + 1, sizeof(char));
+    double* rhs = checked_calloc(constr_count + 1, sizeof(double));
+
+    int i;
+
+    for (i = 0; i < var_count; i++) {
+        ub[i] = 1.0;
+        vtype[i] = var_type;
+    }
+    for (i = 0; i < numnz; i++) {
+        coeffs[i] = 1.0;
+    }
+    for (i = 0; i < constr_count; i++) {
+        sense[i] = GRB_EQUAL;
+        rhs[i] = 1.0;
+    }
+
+    if (GRBnewmodel(env, model, "sudoku", var_count, lp_model->obj, NULL, ub,
+                    vtype, NULL)) {
+        ret = LP_GUROBI_ERR;
+        goto cleanup;
+    }
+
+    if (GRBsetintattr(*model, GRB_INT_ATTR_MODELSENSE, GRB_MINIMIZE) ||
+        GRBaddconstrs(*model, constr_count, numnz, lp_model->constr_start,
+                      lp_model->constr_vars, coeffs, sense, rhs, NULL) ||
+        GRBupdatemodel(*model)) {
+        ret = LP_GUROBI_ERR;
+    }
+
+cleanup:
+    free(rhs);
+    free(sense);
+    free(coeffs);
+    free(vtype);
+    free(ub);
+    return ret;
+}
+
+/**
+ * Create a live model from `template`, holding the unrestricted template.
+ */
+static lp_status_t live_create(gurobi_live_t** live, GRBenv* env,
+                               const lp_model_t* template, char var_type) {
+    lp_status_t ret;
+    GRBmodel* model = NULL;
+    gurobi_live_t* cur;
+    int var_count = template->var_count;
+    int constr_count = template->constr_count;
+    int max_count = var_count > constr_count ? var_count : constr_count;
+    int i;
+
+    ret = load_model(env, &model, template, var_type);
+    if (ret != LP_SUCCESS) {
+        GRBfreemodel(model);
+        return ret;
+    }
+
+    cur = checked_malloc(sizeof(gurobi_live_t));
+    cur->template = template;
+    cur->model = model;
+
+    cur->var_type = var_type;
+    cur->ub = checked_calloc(var_count + 1, sizeof(double));
+    cur->rhs = checked_calloc(constr_count + 1, sizeof(double));
+    cur->obj = checked_calloc(var_count + 1, sizeof(double));
+    cur->next_ub = checked_calloc(var_count + 1, sizeof(double));
+    cur->next_rhs = checked_calloc(constr_count + 1, sizeof(double));
+    cur->next_obj = checked_calloc(var_count + 1, sizeof(double));
+    cur->changed_ind = checked_calloc(max_count + 1, sizeof(int));
+    cur->changed_vals = checked_calloc(max_count + 1, sizeof(double));
+    cur->x = checked_calloc(var_count + 1, sizeof(double));
+    cur->has_start = FALSE;
+    cur->next = NULL;
+
+    for (i = 0; i < var_count; i++) {
+        cur->ub[i] = 1.0;
+        cur->obj[i] = template->obj[i];
+    }
+    for (i = 0; i < constr_count; i++) {
+        cur->rhs[i] = 1.0;
+    }
+
+    *live = cur;
+    return LP_SUCCESS;
+}
+
+/**
+ * Find the live model of the geometry of `board` in `state`, creating it from
+ * the geometry's cached template if there is none, and move it to the front.
+ * The least recently used model is freed once there are more than
+ * `GUROBI_MAX_LIVE_MODELS`.
+ */
+static lp_status_t get_live(gurobi_state_t* state, gurobi_live_t** live,
+                            const board_t* board, char var_type) {
+    const lp_model_t* template =
+        lp_template_cache_get(&state->templates, board);
+    gurobi_live_t** prev_ptr;
+    gurobi_live_t* cur;
+    int count = 0;
+
+    for (prev_ptr = &state->live; *prev_ptr; prev_ptr = &(*prev_ptr)->next) {
+        if ((*prev_ptr)->template == template) {
+            cur = *prev_ptr;
+            *prev_ptr = cur->next;
+            cur->next = state->live;
+            state->live = cur;
+
+            *live = cur;
+            return LP_SUCCESS;
+        }
+    }
+
+    if (live_create(&cur, state->env, template, var_type) != LP_SUCCESS) {
+        return LP_GUROBI_ERR;
+    }
+
+    cur->next = state->live;
+    state->live = cur;
+
+    for (prev_ptr = &state->live; *prev_ptr; prev_ptr = &(*prev_ptr)->next) {
+        if (++count > GUROBI_MAX_LIVE_MODELS) {
+            live_free(*prev_ptr);
+            *prev_ptr = NULL;
+            break;
+        }
+    }
+
+    *live = cur;
+    return LP_SUCCESS;
+}
+
+/**
+ * Set the entries of the double attribute `attr` whose values in `next` differ
+ * from those in `cur`, and copy `next` to `cur`.
+ */
+static lp_status_t update_attr(gurobi_live_t* live, const char* attr,
+                               double* cur, const double* next, int count) {
+    int changed = 0;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        if (cur[i] != next[i]) {
+            live->changed_ind[changed] = i;
+            live->changed_vals[changed] = next[i];
+            cur[i] = next[i];
+            changed++;
+        }
+    }
+
+    if (changed && GRBsetdblattrlist(live->model, attr, changed,
+                                     live->changed_ind, live->changed_vals)) {
+        return LP_GUROBI_ERR;
+    }
+
+    return LP_SUCCESS;
+}
+
+/**
+ * Restrict `live` to `board` with variables of type `var_type`. Integer solves
+ * are started from the previous integer solution, while continuous solves
+ * start from the previous basis, which Gurobi keeps across bound and
+ * right-hand side changes.
+ */
+static lp_status_t restrict_model(gurobi_live_t* live, const board_t* board,
+                                  char var_type) {
+    int var_count = live->template->var_count;
+    int constr_count = live->template->constr_count;
+
+    lp_model_restrict(live->template, board, live->next_ub, live->next_rhs,
+                      live->next_obj);
+
+    if (update_attr(live, GRB_DBL_ATTR_UB, live->ub, live->next_ub,
+                    var_count) != LP_SUCCESS ||
+        update_attr(live, GRB_DBL_ATTR_RHS, live->rhs, live->next_rhs,
+                    constr_count) != LP_SUCCESS ||
+        update_attr(live, GRB_DBL_ATTR_OBJ, live->obj, live->next_obj,
+                    var_count) != LP_SUCCESS) {
+        return LP_GUROBI_ERR;
+    }
+
+    if (var_type != live->var_type) {
+        int i;
+        char* vtype = checked_calloc(var_count + 1, sizeof(char));
+        int err;
+
+        for (i = 0; i < var_count; i++) {
+            vtype[i] = var_type;
+        }
+
+        err = GRBsetcharattrarray(live->model, GRB_CHAR_ATTR_VTYPE, 0,
+                                  var_count, vtype);
+        free(vtype);
+
+        if (err) {
+            return LP_GUROBI_ERR;
+        }
+        live->var_type = var_type;
+    }
+
+    if (var_type == GRB_BINARY && live->has_start &&
+        GRBsetdblattrarray(live->model, GRB_DBL_ATTR_START, 0, var_count,
+                           live->x)) {
+        return LP_GUROBI_ERR;
+    }
+
+    return GRBupdatemodel(live->model) ? LP_GUROBI_ERR : LP_SUCCESS;
+}
+
+/**
+ * Report the nonzero values `x` of the variables of `lp_model` to `callback`.
+ * If `ub` is not null, variables whose upper bound in it is 0 are skipped.
+ */
+static void report_var_values(const lp_model_t* lp_model, const double* ub,
+                              const double* x, const board_t* board,
+                              lp_val_callback_t callback, void* callback_ctx) {
+    int block_size = board_block_size(board);
+    int idx, var_idx;
+
+    for (idx = 0; idx < block_size * block_size; idx++) {
+        for (var_idx = lp_model->cell_start[idx];
+             var_idx < lp_model->cell_start[idx + 1]; var_idx++) {
+            if ((!ub || ub[var_idx] > 0.0) && x[var_idx] > 0.0) {
+                int row, col;
+                board_cell_position(board, idx, &row, &col);
+                callback(block_size, row, col, lp_model->var_vals[var_idx],
+                         x[var_idx], callback_ctx);
+            }
+        }
+    }
+}
+
+/**
+ * Optimize `model`, returning `LP_SUCCESS` if an optimal solution was found.
+ */
+static lp_status_t optimize(GRBmodel* model, lp_stats_t* stats) {
+    clock_t start = clock();
+    int optim_status;
+
+    if (GRBoptimize(model)) {
+        return LP_GUROBI_ERR;
+    }
+    lp_stats_add_time(&stats->solve_time, start);
+
+    if (GRBgetintattr(model, GRB_INT_ATTR_STATUS, &optim_status)) {
+        return LP_GUROBI_ERR;
+    }
+
+    if (optim_status == GRB_OPTIMAL) {
+        return LP_SUCCESS;
+    } else if (optim_status == GRB_INFEASIBLE ||
+               optim_status == GRB_INF_OR_UNBD) {
+        return LP_INFEASIBLE;
+    }
+    return LP_GUROBI_ERR;
+}
+
+/**
+ * Solve `board` with a model of its candidates built for this solve alone, so
+ * that memory stays proportional to the number of candidates.
+ */
+static lp_status_t solve_direct(gurobi_state_t* state, board_t* board,
+                                char var_type, lp_val_callback_t callback,
+                                void* callback_ctx, lp_stats_t* stats) {
+    lp_status_t ret;
+
+    GRBmodel* model = NULL;
+    lp_model_t lp_model;
+    double* x;
+    clock_t start = clock();
+
+    if (!lp_model_init(&lp_model, board)) {
+        return LP_INFEASIBLE;
+    }
+
+    x = checked_calloc(lp_model.var_count + 1, sizeof(double));
+
+    ret = load_model(state->env, &model, &lp_model, var_type);
+    lp_stats_add_time(&stats->build_time, start);
+    if (ret == LP_SUCCESS) {
+        ret = optimize(model, stats);
+    }
+
+    if (ret == LP_SUCCESS) {
+        if (GRBgetdblattrarray(model, GRB_DBL_ATTR_X, 0, lp_model.var_count,
+                               x)) {
+            ret = LP_GUROBI_ERR;
+        } else {
+            report_var_values(&lp_model, NULL, x, board, callback,
+                              callback_ctx);
+        }
+    }
+
+    GRBfreemodel(model);
+    free(x);
+    lp_model_destroy(&lp_model);
+    return ret;
+}
+
+static lp_status_t gurobi_solve(void* state, board_t* board,
+                                lp_var_type_t var_type,
+                                lp_val_callback_t callback, void* callback_ctx,
+                                lp_stats_t* stats) {
+    lp_status_t ret = LP_SUCCESS;
+
+    gurobi_state_t* grb_state = state;
+    gurobi_live_t* live = NULL;
+    char grb_var_type =
+        var_type == LP_VAR_BINARY ? GRB_BINARY : GRB_CONTINUOUS;
+    clock_t start = clock();
+
+    if (board_block_size(board) > GUROBI_MAX_LIVE_BLOCK_SIZE) {
+        return solve_direct(grb_state, board, grb_var_type, callback,
+                            callback_ctx, stats);
+    }
+
+    ret = get_live(grb_state, &live, board, grb_var_type);
+    if (ret == LP_SUCCESS) {
+        ret = restrict_model(live, board, grb_var_type);
+    }
+    lp_stats_add_time(&stats->build_time, start);
+    if (ret == LP_SUCCESS) {
+        ret = optimize(live->model, stats);
+    }
+
+    if (ret == LP_SUCCESS) {
+        if (GRBgetdblattrarray(live->model, GRB_DBL_ATTR_X, 0,
+                               live->template->var_count, live->x)) {
+            ret = LP_GUROBI_ERR;
+        } else {
+            live->has_start = live->var_type == GRB_BINARY;
+            report_var_values(live->template, live->ub, live->x, board,
+                              callback, callback_ctx);
+        }
+    }
+
+    /* After an error, the live model may no longer match the recorded
+     * attribute values. */
+    if (ret == LP_GUROBI_ERR && live) {
+        discard_live(grb_state, live);
+    }
+    return ret;
+}
+
+const lp_backend_t lp_gurobi_backend = {"gurobi", gurobi_create, gurobi_destroy,
+                                        gurobi_solve};
@@ -0,0 +1,355 @@
+#include "lp_model.h"
+
+#include "bitset.h"
+#include "checked_alloc.h"
+#include "geometry.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Create a variable for every candidate of every empty cell of `board`, in
+ * order of cell and then value. If an empty cell without candidates is found,
+ * false will be returned (the board is unsolvable) and nothing is allocated.
+ */
+static bool_t compute_cell_vars(lp_model_t* model, const board_t* board) {
+    bool_t ret = TRUE;
+
+    int cell_count = model->block_size * model->block_size;
+    int idx;
+    int count = 0;
+
+    board_candidates_t candidates;
+    board_compute_all_candidates(board, &candidates);
+
+    model->cell_start = checked_calloc(cell_count + 1, sizeof(int));
+
+    for (idx = 0; idx < cell_count; idx++) {
+        model->cell_start[idx] = count;
+
+        if (!board_get_value_at(board, idx)) {
+            int candidate_count = bitset_count(
+                board_candidates_access_at(&candidates, idx), candidates.words);
+
+            if (!candidate_count) {
+                free(model->cell_start);
+                ret = FALSE;
+                goto cleanup;
+            }
+
+            count += candidate_count;
+        }
+    }
+    model->cell_start[cell_count] = count;
+    model->var_count = count;
+
+    model->var_vals = checked_calloc(count + 1, sizeof(int));
+
+    for (idx = 0; idx < cell_count; idx++) {
+        const bitset_word_t* set = board_candidates_access_at(&candidates, idx);
+        int* vals = &model->var_vals[model->cell_start[idx]];
+        int bit;
+
+        if (board_get_value_at(board, idx)) {
+            continue;
+        }
+
+        for (bit = bitset_next(set, candidates.words, 0); bit != -1;
+             bit = bitset_next(set, candidates.words, bit + 1)) {
+            *vals++ = bit + 1;
+        }
+    }
+
+cleanup:
+    board_candidates_destroy(&candidates);
+    return ret;
+}
+
+/**
+ * Set the objective coefficient of every variable to the number of candidates
+ * of its cell.
+ */
+static void compute_obj(lp_model_t* model) {
+    int idx;
+
+    for (idx = 0; idx < model->block_size * model->block_size; idx++) {
+        int count = model->cell_start[idx + 1] - model->cell_start[idx];
+        int var_idx;
+
+        for (var_idx = model->cell_start[idx];
+             var_idx < model->cell_start[idx + 1]; var_idx++) {
+            model->obj[var_idx] = count;
+        }
+    }
+}
+
+/**
+ * Append a constraint on the `numnz` variables stored after the end of the
+ * last constraint, unless there are none.
+ */
+static void end_constraint(lp_model_t* model, int numnz) {
+    if (numnz) {
+        model->constr_start[model->constr_count + 1] =
+            model->constr_start[model->constr_count] + numnz;
+        model->constr_count++;
+    }
+}
+
+/**
+ * Add a constraint for every cell, requiring it to hold exactly one value.
+ */
+static void add_cell_constraints(lp_model_t* model) {
+    int idx;
+
+    for (idx = 0; idx < model->block_size * model->block_size; idx++) {
+        int* vars =
+            &model->constr_vars[model->constr_start[model->constr_count]];
+        int numnz = 0;
+
+        int var_idx;
+        for (var_idx = model->cell_start[idx];
+             var_idx < model->cell_start[idx + 1]; var_idx++) {
+            vars[numnz++] = var_idx;
+        }
+
+        end_constraint(model, numnz);
+    }
+}
+
+/**
+ * Add a constraint for every value in every row, column and block, requiring
+ * it to appear exactly once in that unit. Units are enumerated from the board's
+ * geometry tables, and the variables of each unit are distributed among its
+ * constraints by value, so only existing variables are visited.
+ */
+static void add_unit_constraints(lp_model_t* model, const board_t* board) {
+    int block_size = model->block_size;
+    int unit_idx;
+
+    /* Number of variables for every value in the current unit, then the
+     * position of the next variable of every value in `constr_vars`. */
+    int* value_pos = checked_calloc(block_size + 1, sizeof(int));
+
+    for (unit_idx = 0; unit_idx < UK_COUNT * block_size; unit_idx++) {
+        const int* unit = geometry_unit(board->geom, unit_idx);
+        int pos = model->constr_start[model->constr_count];
+        int local_off, var_idx, val;
+
+        memset(value_pos, 0, (block_size + 1) * sizeof(int));
+        for (local_off = 0; local_off < block_size; local_off++) {
+            int idx = unit[local_off];
+            for (var_idx = model->cell_start[idx];
+                 var_idx < model->cell_start[idx + 1]; var_idx++) {
+                value_pos[model->var_vals[var_idx]]++;
+            }
+        }
+
+        for (val = 1; val <= block_size; val++) {
+            int numnz = value_pos[val];
+            value_pos[val] = pos;
+            pos += numnz;
+            end_constraint(model, numnz);
+        }
+
+        for (local_off = 0; local_off < block_size; local_off++) {
+            int idx = unit[local_off];
+            for (var_idx = model->cell_start[idx];
+                 var_idx < model->cell_start[idx + 1]; var_idx++) {
+                model->constr_vars[value_pos[model->var_vals[var_idx]]++] =
+                    var_idx;
+            }
+        }
+    }
+
+    free(value_pos);
+}
+
+bool_t lp_model_init(lp_model_t* model, const board_t* board) {
+    int cell_count = board_block_size(board) * board_block_size(board);
+
+    model->block_size = board_block_size(board);
+
+    if (!compute_cell_vars(model, board)) {
+        return FALSE;
+    }
+
+    model->obj = checked_calloc(model->var_count + 1, sizeof(double));
+    compute_obj(model);
+
+    /* Every variable appears in its cell's constraint and in one constraint
+     * for each of the cell's units. */
+    model->constr_count = 0;
+    model->constr_start =
+        checked_calloc(cell_count + UK_COUNT * cell_count + 1, sizeof(int));
+    model->constr_vars =
+        checked_calloc((1 + UK_COUNT) * model->var_count + 1, sizeof(int));
+
+    add_cell_constraints(model);
+    add_unit_constraints(model, board);
+
+    return TRUE;
+}
+
+void lp_model_size(const board_t* board, int* var_count, int* constr_count) {
+    int block_size = board_block_size(board);
+    int idx, unit_idx;
+
+    board_candidates_t candidates;
+    bitset_word_t* unit_values;
+
+    board_compute_all_candidates(board, &candidates);
+    unit_values = checked_calloc(candidates.words, sizeof(bitset_word_t));
+
+    *var_count = 0;
+    *constr_count = 0;
+
+    for (idx = 0; idx < block_size * block_size; idx++) {
+        if (!board_get_value_at(board, idx)) {
+            *var_count += bitset_count(
+                board_candidates_access_at(&candidates, idx), candidates.words);
+            (*constr_count)++;
+        }
+    }
+
+    /* A unit has a constraint for every value that is a candidate of one of
+     * its cells. */
+    for (unit_idx = 0; unit_idx < UK_COUNT * block_size; unit_idx++) {
+        const int* unit = geometry_unit(board->geom, unit_idx);
+        int local_off, word;
+
+        memset(unit_values, 0, candidates.words * sizeof(bitset_word_t));
+        for (local_off = 0; local_off < block_size; local_off++) {
+            const bitset_word_t* set =
+                board_candidates_access_at(&candidates, unit[local_off]);
+            for (word = 0; word < candidates.words; word++) {
+                unit_values[word] |= set[word];
+            }
+        }
+
+        *constr_count += bitset_count(unit_values, candidates.words);
+    }
+
+    free(unit_values);
+    board_candidates_destroy(&candidates);
+}
+
+void lp_model_init_template(lp_model_t* model, int m, int n,
+                            board_layout_t layout) {
+    board_t board;
+
+    board_init_layout(&board, m, n, layout);
+    lp_model_init(model, &board);
+    board_destroy(&board);
+}
+
+void lp_model_restrict(const lp_model_t* model, const board_t* board,
+                       double* ub, double* rhs, double* obj) {
+    int block_size = model->block_size;
+    int idx, var_idx, i;
+
+    board_candidates_t candidates;
+    board_compute_all_candidates(board, &candidates);
+
+    for (idx = 0; idx < block_size * block_size; idx++) {
+        const bitset_word_t* set = board_candidates_access_at(&candidates, idx);
+        int count = board_get_value_at(board, idx)
+                        ? 0
+                        : bitset_count(set, candidates.words);
+
+        for (var_idx = model->cell_start[idx];
+             var_idx < model->cell_start[idx + 1]; var_idx++) {
+            bool_t candidate =
+                count && BITSET_TEST(set, model->var_vals[var_idx] - 1);
+
+            ub[var_idx] = candidate ? 1.0 : 0.0;
+            obj[var_idx] = candidate ? count : 0.0;
+        }
+    }
+
+    for (i = 0; i < model->constr_count; i++) {
+        int j;
+
+        rhs[i] = 0.0;
+        for (j = model->constr_start[i]; j < model->constr_start[i + 1]; j++) {
+            if (ub[model->constr_vars[j]] > 0.0) {
+                rhs[i] = 1.0;
+                break;
+            }
+        }
+    }
+
+    /* The template's first constraints are those of the cells, in order. An
+     * empty cell must hold a value even if it has no candidates left. */
+    for (idx = 0; idx < block_size * block_size; idx++) {
+        if (!board_get_value_at(board, idx)) {
+            rhs[idx] = 1.0;
+        }
+    }
+
+    board_candidates_destroy(&candidates);
+}
+
+void lp_model_destroy(lp_model_t* model) {
+    free(model->constr_vars);
+    free(model->constr_start);
+    free(model->obj);
+    free(model->var_vals);
+    free(model->cell_start);
+}
+
+int lp_model_var(const lp_model_t* model, int idx, int val) {
+    int lo = model->cell_start[idx];
+    int hi = model->cell_start[idx + 1];
+
+    /* The variables of a cell are sorted by value. */
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+
+        if (model->var_vals[mid] < val) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo < model->cell_start[idx + 1] && model->var_vals[lo] == val ? lo
+                                                                         : -1;
+}
+
+void lp_template_cache_init(lp_template_cache_t* cache) { cache->head = NULL; }
+
+void lp_template_cache_destroy(lp_template_cache_t* cache) {
+    lp_template_t* cur = cache->head;
+
+    while (cur) {
+        lp_template_t* next = cur->next;
+        lp_model_destroy(&cur->model);
+        free(cur);
+        cur = next;
+    }
+
+    cache->head = NULL;
+}
+
+const lp_model_t* lp_template_cache_get(lp_template_cache_t* cache,
+                                        const board_t* board) {
+    board_layout_t layout = board_get_layout(board);
+    lp_template_t* cur;
+
+    for (cur = cache->head; cur; cur = cur->next) {
+        if (cur->m == board->m && cur->n == board->n &&
+            cur->layout == layout) {
+            return &cur->model;
+        }
+    }
+
+    cur = checked_malloc(sizeof(lp_template_t));
+    cur->m = board->m;
+    cur->n = board->n;
+    cur->layout = layout;
+    lp_model_init_template(&cur->model, board->m, board->n, layout);
+
+    cur->next = cache->head;
+    cache->head = cur;
+    return &cur->model;
+}
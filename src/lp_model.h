@@ -0,0 +1,117 @@
+/**
+ * lp_model.h - Sparse linear programming models of boards.
+ */
+
+#ifndef LP_MODEL_H
+#define LP_MODEL_H
+
+#include "board.h"
+#include "bool.h"
+
+/**
+ * The model of a board: a variable for every candidate of every empty cell,
+ * and an equality constraint with right-hand side 1 for every empty cell and
+ * for every value missing from every row, column and block. Every coefficient
+ * is 1. Constraints are stored by rows, in compressed sparse row form.
+ */
+typedef struct lp_model {
+    int block_size;
+
+    /* The variables of cell `idx` are `[cell_start[idx], cell_start[idx + 1])`,
+     * in increasing order of value, and `var_vals` holds the (1-based) value of
+     * every variable. Memory is proportional to the number of candidates. */
+    int* cell_start;
+    int* var_vals;
+    int var_count;
+
+    /* Objective coefficient of every variable, favoring cells with fewer
+     * candidates when minimizing. */
+    double* obj;
+
+    /* The variables of constraint `i` are
+     * `constr_vars[constr_start[i], constr_start[i + 1])`. */
+    int constr_count;
+    int* constr_start;
+    int* constr_vars;
+} lp_model_t;
+
+/**
+ * Build the model of `board`. Returns false, initializing nothing, if some
+ * empty cell has no candidates (the board is unsolvable).
+ */
+bool_t lp_model_init(lp_model_t* model, const board_t* board);
+
+/**
+ * Compute the number of variables and constraints in the model of `board`
+ * without building it.
+ */
+void lp_model_size(const board_t* board, int* var_count, int* constr_count);
+
+/**
+ * Build the model of an empty board with the specified dimensions and layout.
+ * Such a template has a variable for every value of every cell and never has
+ * empty constraints, so it can be restricted to any board of the same geometry
+ * with `lp_model_restrict`.
+ */
+void lp_model_init_template(lp_model_t* model, int m, int n,
+                            board_layout_t layout);
+
+/**
+ * Compute the upper bounds `ub`, right-hand sides `rhs` and objective
+ * coefficients `obj` that restrict the template `model` to `board`. The
+ * restricted template has the same feasible set and objective as the model of
+ * `board` built by `lp_model_init`: variables that model lacks are fixed at 0,
+ * constraints it drops have right-hand side 0, and an empty cell without
+ * candidates is left with an unsatisfiable constraint.
+ */
+void lp_model_restrict(const lp_model_t* model, const board_t* board,
+                       double* ub, double* rhs, double* obj);
+
+/**
+ * Destroy `model`, releasing any allocated resources.
+ */
+void lp_model_destroy(lp_model_t* model);
+
+/**
+ * Get the index of the variable for (1-based) value `val` in cell `idx`, or -1
+ * if there is none. This takes time logarithmic in the number of candidates of
+ * the cell; walk `cell_start` and `var_vals` to visit every variable.
+ */
+int lp_model_var(const lp_model_t* model, int idx, int val);
+
+/**
+ * A cached template (see `lp_model_init_template`).
+ */
+typedef struct lp_template {
+    int m;
+    int n;
+    board_layout_t layout;
+    lp_model_t model;
+    struct lp_template* next;
+} lp_template_t;
+
+/**
+ * Templates built so far, one per board geometry.
+ */
+typedef struct lp_template_cache {
+    lp_template_t* head;
+} lp_template_cache_t;
+
+/**
+ * Initialize an empty template cache.
+ */
+void lp_template_cache_init(lp_template_cache_t* cache);
+
+/**
+ * Destroy `cache` and every template in it.
+ */
+void lp_template_cache_destroy(lp_template_cache_t* cache);
+
+/**
+ * Retrieve the template of the geometry of `board`, building it if it is not
+ * already cached. The template remains valid until the cache is destroyed.
+ */
+const lp_model_t* lp_template_cache_get(lp_template_cache_t* cache,
+                                        const board_t* board);
+
+#endif
@@ -0,0 +1,182 @@
+#include "lp_backend.h"
+
+#include "board.h"
+#include "bool.h"
+#include "checked_alloc.h"
+#include "dlx.h"
+#include "lp_model.h"
+#include "simplex.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <time.h>
+
+static bool_t native_create(void** state) {
+    *state = NULL;
+    return TRUE;
+}
+
+static void native_destroy(void* state) { (void)state; }
+
+/**
+ * Check whether `board` has any empty cells.
+ */
+static bool_t has_empty_cells(const board_t* board) {
+    int block_size = board_block_size(board);
+    int idx;
+
+    for (idx = 0; idx < block_size * block_size; idx++) {
+        if (!board_get_value_at(board, idx)) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * Solve the integer model of `board` by exact cover search.
+ */
+static lp_status_t solve_exact(board_t* board, lp_val_callback_t callback,
+                               void* callback_ctx, lp_stats_t* stats) {
+    lp_status_t ret = LP_SUCCESS;
+
+    int block_size = board_block_size(board);
+    board_t solution;
+    dlx_t dlx;
+    clock_t start = clock();
+    bool_t solved;
+    int idx;
+
+    /* With no empty cells the model has no variables or constraints, and is
+     * trivially feasible even if the board has conflicts. */
+    if (!has_empty_cells(board)) {
+        return LP_SUCCESS;
+    }
+
+    board_clone(&solution, board);
+    dlx_init(&dlx, board);
+    lp_stats_add_time(&stats->build_time, start);
+
+    start = clock();
+    solved = dlx_solve(&dlx, &solution);
+    lp_stats_add_time(&stats->solve_time, start);
+
+    if (!solved) {
+        ret = LP_INFEASIBLE;
+        goto cleanup;
+    }
+
+    for (idx = 0; idx < block_size * block_size; idx++) {
+        if (!board_get_value_at(board, idx)) {
+            int row, col;
+            board_cell_position(board, idx, &row, &col);
+            callback(block_size, row, col, board_get_value_at(&solution, idx),
+                     1.0, callback_ctx);
+        }
+    }
+
+cleanup:
+    dlx_destroy(&dlx);
+    board_destroy(&solution);
+    return ret;
+}
+
+/**
+ * Solve the continuous model of `board` with the simplex method.
+ */
+static lp_status_t solve_relaxation(board_t* board,
+                                    lp_val_callback_t callback,
+                                    void* callback_ctx, lp_stats_t* stats) {
+    lp_status_t ret = LP_SUCCESS;
+
+    int block_size = board_block_size(board);
+    clock_t start = clock();
+    simplex_status_t status;
+    simplex_problem_t problem;
+    lp_model_t model;
+    double* rhs;
+    double* cost;
+    double* upper;
+    double* x;
+    int idx, var_idx, i;
+
+    if (!lp_model_init(&model, board)) {
+        return LP_INFEASIBLE;
+    }
+
+    rhs = checked_calloc(model.constr_count + 1, sizeof(double));
+    cost = checked_calloc(model.var_count + 1, sizeof(double));
+    upper = checked_calloc(model.var_count + 1, sizeof(double));
+    x = checked_calloc(model.var_count + 1, sizeof(double));
+
+    for (i = 0; i < model.constr_count; i++) {
+        rhs[i] = 1.0;
+    }
+    for (i = 0; i < model.var_count; i++) {
+        upper[i] = 1.0;
+    }
+
+    problem.rows = model.constr_count;
+    problem.cols = model.var_count;
+    problem.row_start = model.constr_start;
+    problem.row_cols = model.constr_vars;
+    problem.row_values = NULL;
+    problem.rhs = rhs;
+    /* Every cell holds one value in total at any feasible point, so the
+     * objective is constant over the feasible set. Dropping it lets phase 1
+     * alone find an optimum. */
+    problem.cost = cost;
+    problem.upper = upper;
+    lp_stats_add_time(&stats->build_time, start);
+
+    start = clock();
+    status = simplex_solve(&problem, x);
+    lp_stats_add_time(&stats->solve_time, start);
+
+    switch (status) {
+    case SIMPLEX_OPTIMAL:
+        break;
+    case SIMPLEX_INFEASIBLE:
+        ret = LP_INFEASIBLE;
+        goto cleanup;
+    default:
+        ret = LP_GUROBI_ERR;
+        goto cleanup;
+    }
+
+    for (idx = 0; idx < block_size * block_size; idx++) {
+        for (var_idx = model.cell_start[idx];
+             var_idx < model.cell_start[idx + 1]; var_idx++) {
+            if (x[var_idx] > SIMPLEX_TOLERANCE) {
+                int row, col;
+                board_cell_position(board, idx, &row, &col);
+                callback(block_size, row, col, model.var_vals[var_idx],
+                         x[var_idx], callback_ctx);
+            }
+        }
+    }
+
+cleanup:
+    free(x);
+    free(upper);
+    free(cost);
+    free(rhs);
+    lp_model_destroy(&model);
+    return ret;
+}
+
+static lp_status_t native_solve(void* state, board_t* board,
+                                lp_var_type_t var_type,
+                                lp_val_callback_t callback,
+                                void* callback_ctx, lp_stats_t* stats) {
+    (void)state;
+
+    if (var_type == LP_VAR_CONTINUOUS) {
+        return solve_relaxation(board, callback, callback_ctx, stats);
+    }
+
+    return solve_exact(board, callback, callback_ctx, stats);
+}
+
+const lp_backend_t lp_native_backend = {"native", native_create, native_destroy,
+                                        native_solve};
@@ -6,12 +6,14 @@
 #include "mainaux.h"
 
 #include "backtrack.h"
+#include "bitset.h"
 #include "board.h"
 #include "bool.h"
 #include "checked_alloc.h"
 #include "game.h"
 #include "history.h"
 #include "lp.h"
+#include "parallel.h"
 #include "parser.h"
 #include <errno.h>
 #include <stdarg.h>
@@ -46,14 +48,42 @@ void __attribute__((format(printf, 1, 2))) print_success(const char* fmt, ...) {
 
 /* Game Initialization/Destruction */
 
+/**
+ * Read the number of threads to use when counting solutions from the
+ * `SUDOKU_THREADS` environment variable, defaulting to 1.
+ */
+static int get_thread_count(void) {
+    const char* value = getenv("SUDOKU_THREADS");
+    long count;
+
+    if (!value) {
+        return 1;
+    }
+
+    count = strtol(value, NULL, 10);
+    return count > 0 && count <= PARALLEL_MAX_THREADS ? (int)count : 1;
+}
+
+/**
+ * Check whether LP statistics should be printed after every command, as
+ * requested by setting the `SUDOKU_LP_STATS` environment variable.
+ */
+static bool_t get_report_lp_stats(void) {
+    const char* value = getenv("SUDOKU_LP_STATS");
+    return value && *value && strcmp(value, "0");
+}
+
 bool_t init_game(game_t* game) {
     if (!lp_env_create(&game->lp_env)) {
-        print_error("Failed to initialize Gurobi.");
+        print_error("Failed to initialize the LP solver.");
         return FALSE;
     }
 
     game->mode = GM_INIT;
     game->mark_errors = TRUE;
+    game->thread_count = get_thread_count();
+    game->report_lp_stats = get_report_lp_stats();
+    search_tt_init(&game->count_tt, SEARCH_TT_DEFAULT_BITS);
 
     /* Note: this placeholder can be destroyed via board_destroy without any
      * ill effects. */
@@ -67,6 +97,7 @@ void destroy_game(game_t* game) {
     lp_env_free(game->lp_env);
     history_destroy(&game->history);
     board_destroy(&game->board);
+    search_tt_destroy(&game->count_tt);
 }
 
 /* Prompt Display */
@@ -114,7 +145,7 @@ static void print_usage(command_type_t type) {
         {CT_SAVE, "save <file path>"},
         {CT_HINT, "hint <column> <row>"},
         {CT_GUESS_HINT, "guess_hint <column> <row>"},
-        {CT_NUM_SOLUTIONS, "num_solutions"},
+        {CT_NUM_SOLUTIONS, "num_solutions [limit]"},
         {CT_AUTOFILL, "autofill"},
         {CT_RESET, "reset"},
         {CT_EXIT, "exit"},
@@ -238,10 +269,13 @@ static bool_t load_board_from_file(board_t* board, const char* filename) {
         return TRUE;
     case DS_ERR_FMT:
         print_error("Invalid file format.");
+        break;
     case DS_ERR_CELL:
         print_error("Invalid cell encountered.");
+        break;
     case DS_ERR_IO:
         print_error("Error loading board from file: %s.", strerror(errno));
+        break;
     }
 
     return FALSE;
@@ -255,6 +289,7 @@ static void enter_game_mode(game_t* game, game_mode_t mode, board_t* board) {
     game->mode = mode;
 
     history_clear(&game->history);
+    search_tt_clear(&game->count_tt);
 
     board_destroy(&game->board);
     memcpy(&game->board, board, sizeof(board_t));
@@ -263,26 +298,6 @@ static void enter_game_mode(game_t* game, game_mode_t mode, board_t* board) {
     print_success("Entering %s mode...", game_mode_to_str(mode));
 }
 
-/**
- * Check whether `board` is full.
- */
-static bool_t board_is_full(const board_t* board) {
-    int block_size = board_block_size(board);
-
-    int row;
-    int col;
-
-    for (row = 0; row < block_size; row++) {
-        for (col = 0; col < block_size; col++) {
-            if (cell_is_empty(board_access_const(board, row, col))) {
-                return FALSE;
-            }
-        }
-    }
-
-    return TRUE;
-}
-
 /**
  * Check whether the game board has been solved, printing an appropriate
  * message and switching back to init mode if it has.
@@ -292,7 +307,7 @@ static void game_handle_solved(game_t* game) {
         return;
     }
 
-    if (board_is_legal(&game->board)) {
+    if (board_is_solved(&game->board)) {
         board_t dummy = {0}; /* Note: board_destroy on this is a no-op */
 
         print_success("Puzzle solved successfully!");
@@ -304,11 +319,10 @@ static void game_handle_solved(game_t* game) {
 
 /**
  * Call this after processing a command that may have changed the board -
- * re-mark and reprint the board, notify the user if they have solved the puzzle
- * in solve mode.
+ * reprint the board, notify the user if they have solved the puzzle in solve
+ * mode. Error flags are kept up to date by the board as cells change.
  */
 static void game_board_after_change(game_t* game) {
-    board_mark_errors(&game->board);
     game_board_print(game);
 
     if (game->mode == GM_SOLVE) {
@@ -325,14 +339,13 @@ static void clone_fixed(board_t* dest, const board_t* src) {
     int row;
     int col;
 
-    board_init(dest, src->m, src->n);
+    board_init_layout(dest, src->m, src->n, board_get_layout(src));
 
     for (row = 0; row < block_size; row++) {
         for (col = 0; col < block_size; col++) {
-            const cell_t* src_cell = board_access_const(src, row, col);
-
-            if (cell_is_fixed(src_cell)) {
-                board_access(dest, row, col)->value = src_cell->value;
+            if (board_get_flags(src, row, col) == CF_FIXED) {
+                board_set_value(dest, row, col,
+                                board_get_value(src, row, col));
             }
         }
     }
@@ -346,7 +359,7 @@ static bool_t check_fixed_cells(const board_t* board) {
     bool_t ret;
 
     clone_fixed(&fixed, board);
-    ret = board_is_legal(&fixed);
+    ret = !board_has_conflicts(&fixed);
     board_destroy(&fixed);
 
     return ret;
@@ -363,9 +376,8 @@ static void unfix_cells(board_t* board) {
 
     for (row = 0; row < block_size; row++) {
         for (col = 0; col < block_size; col++) {
-            cell_t* cell = board_access(board, row, col);
-            if (cell_is_fixed(cell)) {
-                board_access(board, row, col)->flags = CF_NONE;
+            if (board_get_flags(board, row, col) == CF_FIXED) {
+                board_set_flags(board, row, col, CF_NONE);
             }
         }
     }
@@ -376,7 +388,7 @@ static void unfix_cells(board_t* board) {
  * Returns whether the board is legal.
  */
 static bool_t game_verify_board_legal(const game_t* game) {
-    if (board_is_legal(&game->board)) {
+    if (!board_has_conflicts(&game->board)) {
         return TRUE;
     }
 
@@ -401,7 +413,7 @@ static bool_t verify_lp_status(lp_status_t status) {
         print_error("Board is not solvable");
         return FALSE;
     case LP_GUROBI_ERR:
-        print_error("Failed to invoke Gurobi");
+        print_error("Failed to invoke the LP solver");
         return FALSE;
     }
     return FALSE;
@@ -508,10 +520,8 @@ static void fix_nonempty_cells(board_t* board) {
 
     for (row = 0; row < block_size; row++) {
         for (col = 0; col < block_size; col++) {
-            cell_t* cell = board_access(board, row, col);
-
-            if (!cell_is_empty(cell)) {
-                cell->flags = CF_FIXED;
+            if (board_get_value(board, row, col)) {
+                board_set_flags(board, row, col, CF_FIXED);
             }
         }
     }
@@ -537,8 +547,6 @@ static bool_t save_board_to_file(const board_t* board, const char* filename) {
  * non-fixed, empty cell, printing an error if they aren't met.
  */
 static bool_t game_verify_can_hint(const game_t* game, int row, int col) {
-    const cell_t* cell;
-
     if (!game_verify_board_legal(game)) {
         return FALSE;
     }
@@ -547,14 +555,12 @@ static bool_t game_verify_can_hint(const game_t* game, int row, int col) {
         return FALSE;
     }
 
-    cell = board_access_const(&game->board, row, col);
-
-    if (cell_is_fixed(cell)) {
+    if (board_get_flags(&game->board, row, col) == CF_FIXED) {
         print_error("Cannot provide hint for fixed cell");
         return FALSE;
     }
 
-    if (!cell_is_empty(cell)) {
+    if (board_get_value(&game->board, row, col)) {
         print_error("Cannot provide hint for non-empty cell");
         return FALSE;
     }
@@ -566,25 +572,34 @@ static bool_t game_verify_can_hint(const game_t* game, int row, int col) {
  * Add all empty cells that only have a single legal value to `delta` (setting
  * them to their legal value).
  */
-static void add_autofill_candidates(delta_list_t* delta, board_t* board) {
+static void add_autofill_candidates(delta_list_t* delta, const board_t* board) {
     int block_size = board_block_size(board);
 
+    board_candidates_t candidates;
     int row;
     int col;
 
+    board_compute_all_candidates(board, &candidates);
+
     for (row = 0; row < block_size; row++) {
         for (col = 0; col < block_size; col++) {
-            if (cell_is_empty(board_access(board, row, col))) {
-                int candidate;
-                if (board_get_single_candidate(board, row, col, &candidate)) {
-                    delta_list_add(delta, row, col, 0, candidate);
-                }
+            const bitset_word_t* set =
+                board_candidates_access(&candidates, row, col);
+
+            if (bitset_count(set, candidates.words) == 1) {
+                delta_list_add(delta, row, col, 0,
+                               bitset_next(set, candidates.words, 0) + 1);
             }
         }
     }
+
+    board_candidates_destroy(&candidates);
 }
 
-bool_t command_execute(game_t* game, command_t* command) {
+/**
+ * Execute a command, returning false if the game should exit.
+ */
+static bool_t execute(game_t* game, command_t* command) {
     switch (command->type) {
     case CT_SOLVE: {
         board_t board;
@@ -604,6 +619,7 @@ bool_t command_execute(game_t* game, command_t* command) {
         }
 
         enter_game_mode(game, GM_SOLVE, &board);
+        board_mark_errors(&game->board);
         game_board_after_change(game);
 
         break;
@@ -627,6 +643,7 @@ bool_t command_execute(game_t* game, command_t* command) {
         }
 
         enter_game_mode(game, GM_EDIT, &board);
+        board_mark_errors(&game->board);
         game_board_after_change(game);
 
         break;
@@ -648,7 +665,6 @@ bool_t command_execute(game_t* game, command_t* command) {
         int row = command->arg.three_int_val.j - 1;
         int val = command->arg.three_int_val.k;
 
-        cell_t* cell;
         delta_list_t updates;
 
         if (!verify_board_indices(&game->board, row, col)) {
@@ -660,15 +676,14 @@ bool_t command_execute(game_t* game, command_t* command) {
             break;
         }
 
-        cell = board_access(&game->board, row, col);
-
-        if (cell_is_fixed(cell)) {
+        if (board_get_flags(&game->board, row, col) == CF_FIXED) {
             print_error("This cell is fixed and cannot be updated.");
             break;
         }
 
         delta_list_init(&updates);
-        delta_list_add(&updates, row, col, cell->value, val);
+        delta_list_add(&updates, row, col,
+                       board_get_value(&game->board, row, col), val);
         game_apply_delta(game, &updates, FALSE);
 
         break;
@@ -824,7 +839,7 @@ bool_t command_execute(game_t* game, command_t* command) {
 
         if (verify_lp_status(status)) {
             print_success("Set (%d, %d) to %d", col + 1, row + 1,
-                          board_access(&solution, row, col)->value);
+                          board_get_value(&solution, row, col));
         }
 
         board_destroy(&solution);
@@ -871,9 +886,22 @@ bool_t command_execute(game_t* game, command_t* command) {
         break;
     }
 
-    case CT_NUM_SOLUTIONS:
-        print_success("Number of solutions: %d", num_solutions(&game->board));
+    case CT_NUM_SOLUTIONS: {
+        int limit = command->arg.int_val;
+
+        if (limit) {
+            long count = num_solutions_limit(&game->board, limit);
+            print_success("Number of solutions: %s%ld",
+                          count == limit ? "at least " : "", count);
+        } else if (game->thread_count > 1) {
+            print_success("Number of solutions: %ld",
+                          parallel_count(&game->board, game->thread_count));
+        } else {
+            print_success("Number of solutions: %ld",
+                          num_solutions_cached(&game->board, &game->count_tt));
+        }
         break;
+    }
 
     case CT_AUTOFILL: {
         delta_list_t delta;
@@ -900,3 +928,37 @@ bool_t command_execute(game_t* game, command_t* command) {
 
     return TRUE;
 }
+
+/**
+ * Print the time spent presolving, building and solving LP models since the
+ * statistics were last reset, along with the work done by presolve, if any
+ * models were solved.
+ */
+static void print_lp_stats(game_t* game) {
+    lp_stats_t stats;
+    lp_env_stats(game->lp_env, &stats);
+
+    if (stats.solves) {
+        printf("LP (%s): %d model(s), presolve %.3fs, build %.3fs, "
+               "solve %.3fs\n",
+               lp_env_backend_name(game->lp_env), stats.solves,
+               stats.presolve_time, stats.build_time, stats.solve_time);
+        printf("Presolve: %d cell(s) fixed, %d variable(s) and %d "
+               "constraint(s) removed, %d model(s) infeasible\n",
+               stats.fixed_cells, stats.removed_vars, stats.removed_constrs,
+               stats.presolve_infeasible);
+    }
+}
+
+bool_t command_execute(game_t* game, command_t* command) {
+    bool_t ret;
+
+    lp_env_reset_stats(game->lp_env);
+    ret = execute(game, command);
+
+    if (game->report_lp_stats) {
+        print_lp_stats(game);
+    }
+
+    return ret;
+}
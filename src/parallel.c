@@ -0,0 +1,327 @@
+#include "parallel.h"
+
+#include "bitset.h"
+#include "bool.h"
+#include "checked_alloc.h"
+#include "search.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+/**
+ * Split subtrees only while fewer than this many tasks per thread are
+ * outstanding.
+ */
+#define PARALLEL_TASKS_PER_THREAD 4
+
+/**
+ * A subtree of the search, reached by placing `values[i]` in `cells[i]` for
+ * every `i` in `[0, depth)` (propagating after each placement).
+ */
+typedef struct parallel_task {
+    int depth;
+    int cells[PARALLEL_MAX_DEPTH];
+    int values[PARALLEL_MAX_DEPTH];
+} parallel_task_t;
+
+/**
+ * A worker's queue of tasks. The owner pushes and pops at the back, while
+ * thieves take from the front, so that stolen tasks tend to be the shallower
+ * (and larger) ones.
+ */
+typedef struct task_deque {
+    pthread_mutex_t lock;
+    parallel_task_t* tasks;
+    int capacity;
+    int head; /* Index of the first task */
+    int tail; /* Index after the last task */
+} task_deque_t;
+
+typedef struct parallel_ctx parallel_ctx_t;
+
+typedef struct worker {
+    parallel_ctx_t* ctx;
+    int id;
+    pthread_t thread;
+    bool_t started; /* Whether `thread` was created successfully */
+    search_t search;
+    bitset_word_t* candidates;
+    long count;
+} worker_t;
+
+/**
+ * State shared by all workers. `lock` protects `pending`, `idle` and
+ * `generation`.
+ */
+struct parallel_ctx {
+    int thread_count;
+    worker_t* workers;
+    task_deque_t* deques;
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int pending;    /* Tasks pushed but not yet completed */
+    int idle;       /* Workers waiting for tasks */
+    int generation; /* Incremented whenever a task is pushed */
+};
+
+static void deque_init(task_deque_t* deque) {
+    pthread_mutex_init(&deque->lock, NULL);
+    deque->capacity = 16;
+    deque->tasks = checked_calloc(deque->capacity, sizeof(parallel_task_t));
+    deque->head = 0;
+    deque->tail = 0;
+}
+
+static void deque_destroy(task_deque_t* deque) {
+    free(deque->tasks);
+    pthread_mutex_destroy(&deque->lock);
+}
+
+static void deque_push(task_deque_t* deque, const parallel_task_t* task) {
+    pthread_mutex_lock(&deque->lock);
+
+    if (deque->tail == deque->capacity) {
+        deque->capacity *= 2;
+        deque->tasks = checked_realloc(
+            deque->tasks, deque->capacity * sizeof(parallel_task_t));
+    }
+    deque->tasks[deque->tail++] = *task;
+
+    pthread_mutex_unlock(&deque->lock);
+}
+
+/**
+ * Take a task from the back (`steal` false) or front (`steal` true) of
+ * `deque`, returning false if it is empty.
+ */
+static bool_t deque_take(task_deque_t* deque, parallel_task_t* task,
+                         bool_t steal) {
+    bool_t ret = FALSE;
+
+    pthread_mutex_lock(&deque->lock);
+
+    if (deque->head < deque->tail) {
+        *task = steal ? deque->tasks[deque->head++]
+                      : deque->tasks[--deque->tail];
+        if (deque->head == deque->tail) {
+            deque->head = 0;
+            deque->tail = 0;
+        }
+        ret = TRUE;
+    }
+
+    pthread_mutex_unlock(&deque->lock);
+    return ret;
+}
+
+/**
+ * Push `task` onto the deque of worker `id`, waking an idle worker to steal it.
+ */
+static void push_task(parallel_ctx_t* ctx, int id,
+                      const parallel_task_t* task) {
+    deque_push(&ctx->deques[id], task);
+
+    pthread_mutex_lock(&ctx->lock);
+    ctx->pending++;
+    ctx->generation++;
+    pthread_cond_signal(&ctx->cond);
+    pthread_mutex_unlock(&ctx->lock);
+}
+
+/**
+ * Find a task for worker `id`, trying its own deque before stealing from the
+ * others.
+ */
+static bool_t find_task(parallel_ctx_t* ctx, int id, parallel_task_t* task) {
+    int i;
+
+    if (deque_take(&ctx->deques[id], task, FALSE)) {
+        return TRUE;
+    }
+
+    for (i = 1; i < ctx->thread_count; i++) {
+        int victim = (id + i) % ctx->thread_count;
+        if (deque_take(&ctx->deques[victim], task, TRUE)) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * Check whether tasks should currently be split rather than counted.
+ */
+static bool_t should_split(parallel_ctx_t* ctx) {
+    bool_t ret;
+
+    pthread_mutex_lock(&ctx->lock);
+    ret = ctx->idle > 0 ||
+          ctx->pending < ctx->thread_count * PARALLEL_TASKS_PER_THREAD;
+    pthread_mutex_unlock(&ctx->lock);
+
+    return ret;
+}
+
+/**
+ * Process `task`: either split it into one child task per candidate of its
+ * branching cell, or count its solutions.
+ */
+static void run_task(worker_t* worker, const parallel_task_t* task) {
+    search_t* search = &worker->search;
+    int best;
+    int i;
+
+    search_reset(search);
+
+    for (i = 0; i < task->depth; i++) {
+        if (!search_place(search, task->cells[i], task->values[i])) {
+            return;
+        }
+    }
+
+    if (task->depth == PARALLEL_MAX_DEPTH || !should_split(worker->ctx)) {
+        worker->count += search_count(search);
+        return;
+    }
+
+    if (!search_propagate(search, &best)) {
+        return;
+    }
+
+    if (best == -1) {
+        worker->count++;
+    } else {
+        parallel_task_t child = *task;
+        int bit;
+
+        search_candidates(search, best, worker->candidates);
+
+        child.cells[child.depth] = best;
+        child.depth++;
+
+        for (bit = bitset_next(worker->candidates, search->words, 0);
+             bit != -1;
+             bit = bitset_next(worker->candidates, search->words, bit + 1)) {
+            child.values[task->depth] = bit + 1;
+            push_task(worker->ctx, worker->id, &child);
+        }
+    }
+}
+
+static void* worker_main(void* arg) {
+    worker_t* worker = arg;
+    parallel_ctx_t* ctx = worker->ctx;
+
+    for (;;) {
+        parallel_task_t task;
+        int generation;
+
+        pthread_mutex_lock(&ctx->lock);
+        generation = ctx->generation;
+        pthread_mutex_unlock(&ctx->lock);
+
+        if (find_task(ctx, worker->id, &task)) {
+            run_task(worker, &task);
+
+            pthread_mutex_lock(&ctx->lock);
+            if (--ctx->pending == 0) {
+                pthread_cond_broadcast(&ctx->cond);
+            }
+            pthread_mutex_unlock(&ctx->lock);
+            continue;
+        }
+
+        pthread_mutex_lock(&ctx->lock);
+        if (ctx->pending == 0) {
+            pthread_mutex_unlock(&ctx->lock);
+            break;
+        }
+
+        /* Only sleep if nothing was pushed since we last looked. */
+        if (generation == ctx->generation) {
+            ctx->idle++;
+            pthread_cond_wait(&ctx->cond, &ctx->lock);
+            ctx->idle--;
+        }
+        pthread_mutex_unlock(&ctx->lock);
+    }
+
+    return NULL;
+}
+
+long parallel_count(const board_t* board, int thread_count) {
+    parallel_ctx_t ctx;
+    parallel_task_t root;
+
+    long count = 0;
+    int i;
+
+    if (thread_count <= 1) {
+        search_t search;
+
+        search_init(&search, board);
+        count = search_count(&search);
+        search_destroy(&search);
+
+        return count;
+    }
+
+    ctx.thread_count = thread_count;
+    ctx.workers = checked_calloc(thread_count, sizeof(worker_t));
+    ctx.deques = checked_calloc(thread_count, sizeof(task_deque_t));
+    pthread_mutex_init(&ctx.lock, NULL);
+    pthread_cond_init(&ctx.cond, NULL);
+    ctx.pending = 0;
+    ctx.idle = 0;
+    ctx.generation = 0;
+
+    /* Searches are set up here, as the geometry cache is not thread-safe. */
+    for (i = 0; i < thread_count; i++) {
+        worker_t* worker = &ctx.workers[i];
+
+        worker->ctx = &ctx;
+        worker->id = i;
+        worker->count = 0;
+        search_init(&worker->search, board);
+        worker->candidates =
+            checked_calloc(worker->search.words, sizeof(bitset_word_t));
+        deque_init(&ctx.deques[i]);
+    }
+
+    root.depth = 0;
+    push_task(&ctx, 0, &root);
+
+    for (i = 0; i < thread_count; i++) {
+        worker_t* worker = &ctx.workers[i];
+        worker->started =
+            !pthread_create(&worker->thread, NULL, worker_main, worker);
+    }
+
+    /* Workers whose threads could not be created run here instead. */
+    for (i = 0; i < thread_count; i++) {
+        if (!ctx.workers[i].started) {
+            worker_main(&ctx.workers[i]);
+        }
+    }
+
+    for (i = 0; i < thread_count; i++) {
+        worker_t* worker = &ctx.workers[i];
+
+        if (worker->started) {
+            pthread_join(worker->thread, NULL);
+        }
+        count += worker->count;
+
+        free(worker->candidates);
+        search_destroy(&worker->search);
+        deque_destroy(&ctx.deques[i]);
+    }
+
+    pthread_cond_destroy(&ctx.cond);
+    pthread_mutex_destroy(&ctx.lock);
+    free(ctx.deques);
+    free(ctx.workers);
+
+    return count;
+}
@@ -0,0 +1,36 @@
+/**
+ * parallel.h - Multithreaded solution counting with work stealing.
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "board.h"
+
+/**
+ * Maximum number of decisions leading to a task's subtree. Subtrees deeper
+ * than this are never split further.
+ */
+#define PARALLEL_MAX_DEPTH 16
+
+/**
+ * Maximum sensible number of worker threads.
+ */
+#define PARALLEL_MAX_THREADS 256
+
+/**
+ * Count the solutions of `board` using `thread_count` worker threads.
+ *
+ * The search tree is split into subtrees, each identified by the values placed
+ * in the cells branched on to reach it. Every worker owns a deque of subtrees:
+ * it takes work from the back of its own deque and, once that is empty, steals
+ * from the front of the others'. While workers are idle, subtrees are split
+ * into one child per candidate of their branching cell rather than counted
+ * outright, giving idle workers something to steal.
+ *
+ * The count is identical to that of `num_solutions`. With a single thread, the
+ * board is counted directly on the calling thread.
+ */
+long parallel_count(const board_t* board, int thread_count);
+
+#endif
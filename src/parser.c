@@ -25,6 +25,7 @@ typedef enum {
     PT_NONE,
     PT_STR,
     PT_OPT_STR,
+    PT_OPT_INT,
     PT_BOOL,
     PT_DOUBLE,
     PT_INT2,
@@ -116,6 +117,21 @@ static parser_error_codes_t parse_arg_payload(command_arg_type_t type,
         arg->str_val = duplicate_str(str);
         break;
     }
+    case PT_OPT_INT: {
+        char* str = strtok_ws(NULL); /* May be null */
+        int val = 0;
+
+        if (str && strtok_ws(NULL) != NULL) {
+            return P_INVALID_NUM_OF_ARGS;
+        }
+
+        if (str && (sscanf(str, "%d", &val) < 1 || val <= 0)) {
+            return P_INVALID_ARGUMENTS;
+        }
+
+        arg->int_val = val;
+        break;
+    }
     case PT_BOOL: {
         char* str_arg;
         int val;
@@ -213,7 +229,7 @@ parser_error_codes_t parse_line(FILE* stream, command_t* cmd,
         {"save", CT_SAVE, AM_EDIT | AM_SOLVE, PT_STR},
         {"hint", CT_HINT, AM_SOLVE, PT_INT2},
         {"guess_hint", CT_GUESS_HINT, AM_SOLVE, PT_INT2},
-        {"num_solutions", CT_NUM_SOLUTIONS, AM_EDIT | AM_SOLVE, PT_NONE},
+        {"num_solutions", CT_NUM_SOLUTIONS, AM_EDIT | AM_SOLVE, PT_OPT_INT},
         {"autofill", CT_AUTOFILL, AM_SOLVE, PT_NONE},
         {"reset", CT_RESET, AM_EDIT | AM_SOLVE, PT_NONE},
         {"exit", CT_EXIT, AM_ALL, PT_NONE},
@@ -74,6 +74,7 @@ typedef struct command_arg_three_int {
 typedef union {
     char* str_val;
     bool_t bool_val;
+    int int_val; /* Optional positive integer (num_solutions), 0 if absent */
     double double_val;
     command_arg_two_int_t two_int_val;
     command_arg_three_int_t three_int_val;
@@ -0,0 +1,513 @@
+#include "search.h"
+
+#include "checked_alloc.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Retrieve the placed-value bitset of the specified (global) unit.
+ */
+static bitset_word_t* unit_mask(const search_t* search, int unit) {
+    return &search->unit_masks[unit * search->words];
+}
+
+/**
+ * Place `value` in the empty cell `idx` and record it on the trail.
+ */
+static void assign(search_t* search, int idx, int value) {
+    const int* units = geometry_cell_units(search->geom, idx);
+    int kind;
+
+    for (kind = 0; kind < UK_COUNT; kind++) {
+        BITSET_SET(unit_mask(search, units[kind]), value - 1);
+    }
+
+    search->values[idx] = value;
+    search->empty_count--;
+    search->hash ^= board_zobrist_key(idx, value);
+    search->trail[search->trail_size++] = idx;
+}
+
+/**
+ * Undo assignments until the trail contains only `mark` cells.
+ */
+static void undo_to(search_t* search, int mark) {
+    while (search->trail_size > mark) {
+        int idx = search->trail[--search->trail_size];
+        const int* units = geometry_cell_units(search->geom, idx);
+        int value = search->values[idx];
+        int kind;
+
+        for (kind = 0; kind < UK_COUNT; kind++) {
+            BITSET_CLEAR(unit_mask(search, units[kind]), value - 1);
+        }
+
+        search->values[idx] = 0;
+        search->empty_count++;
+        search->hash ^= board_zobrist_key(idx, value);
+    }
+}
+
+/**
+ * Compute the candidates of the empty cell `idx` into `cand`, returning their
+ * number.
+ */
+static int cell_candidates(const search_t* search, int idx,
+                           bitset_word_t* cand) {
+    const int* units = geometry_cell_units(search->geom, idx);
+    const bitset_word_t* row = unit_mask(search, units[UK_ROW]);
+    const bitset_word_t* col = unit_mask(search, units[UK_COL]);
+    const bitset_word_t* block = unit_mask(search, units[UK_BLOCK]);
+
+    int i;
+    for (i = 0; i < search->words; i++) {
+        cand[i] = search->full[i] & ~(row[i] | col[i] | block[i]);
+    }
+
+    return bitset_count(cand, search->words);
+}
+
+/**
+ * Fill every empty cell with a single candidate. Returns false if an empty cell
+ * without candidates is found. Otherwise, `*changed` is set if any cell was
+ * filled and `*best` receives the empty cell with the fewest candidates (or -1
+ * if there are none).
+ */
+static bool_t propagate_naked(search_t* search, bool_t* changed, int* best) {
+    int cell_count = search->geom->cell_count;
+    int best_count = search->block_size + 1;
+    int idx;
+
+    *changed = FALSE;
+    *best = -1;
+
+    for (idx = 0; idx < cell_count; idx++) {
+        int count;
+
+        if (search->values[idx]) {
+            continue;
+        }
+
+        count = cell_candidates(search, idx, search->cand);
+        if (count == 0) {
+            return FALSE;
+        }
+
+        if (count == 1) {
+            int bit = bitset_next(search->cand, search->words, 0);
+            assign(search, idx, bit + 1);
+            *changed = TRUE;
+        } else if (count < best_count) {
+            best_count = count;
+            *best = idx;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * Fill every value that has a single possible position within some unit.
+ * Returns false if some unit has a value that can no longer be placed
+ * anywhere. Otherwise, `*changed` is set if any cell was filled.
+ */
+static bool_t propagate_hidden(search_t* search, bool_t* changed) {
+    int block_size = search->block_size;
+    int words = search->words;
+    int unit_idx;
+
+    *changed = FALSE;
+
+    for (unit_idx = 0; unit_idx < UK_COUNT * block_size; unit_idx++) {
+        const int* unit = geometry_unit(search->geom, unit_idx);
+        const bitset_word_t* placed = unit_mask(search, unit_idx);
+
+        int i, bit;
+
+        memset(search->once, 0, words * sizeof(bitset_word_t));
+        memset(search->twice, 0, words * sizeof(bitset_word_t));
+
+        for (i = 0; i < block_size; i++) {
+            int w;
+
+            if (search->values[unit[i]]) {
+                continue;
+            }
+
+            cell_candidates(search, unit[i], search->cand);
+            for (w = 0; w < words; w++) {
+                search->twice[w] |= search->once[w] & search->cand[w];
+                search->once[w] |= search->cand[w];
+            }
+        }
+
+        for (i = 0; i < words; i++) {
+            if (search->full[i] & ~(placed[i] | search->once[i])) {
+                return FALSE;
+            }
+            /* Reuse `once` to hold the values with a single position. */
+            search->once[i] &= ~search->twice[i];
+        }
+
+        for (bit = bitset_next(search->once, words, 0); bit != -1;
+             bit = bitset_next(search->once, words, bit + 1)) {
+            for (i = 0; i < block_size; i++) {
+                /* An earlier placement may have taken this cell or value; the
+                 * next pass will notice if so. */
+                if (!search->values[unit[i]]) {
+                    cell_candidates(search, unit[i], search->cand);
+                    if (BITSET_TEST(search->cand, bit)) {
+                        assign(search, unit[i], bit + 1);
+                        *changed = TRUE;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * Propagate naked and hidden singles until a fixed point is reached. Returns
+ * false on contradiction, otherwise storing the empty cell with the fewest
+ * candidates to `*best` (-1 if the board is full).
+ */
+static bool_t propagate(search_t* search, int* best) {
+    bool_t changed;
+
+    do {
+        if (!propagate_naked(search, &changed, best)) {
+            return FALSE;
+        }
+        if (changed) {
+            continue;
+        }
+
+        if (!propagate_hidden(search, &changed)) {
+            return FALSE;
+        }
+    } while (changed);
+
+    return TRUE;
+}
+
+/**
+ * Push a branching point on `cell`, which should be empty.
+ */
+static void push_frame(search_t* search, int cell) {
+    search_frame_t* frame = &search->frames[search->depth++];
+
+    frame->cell = cell;
+    frame->value = 0;
+    frame->trail_mark = search->trail_size;
+    frame->hash = search->hash;
+    frame->count_mark = search->count;
+    cell_candidates(search, cell, frame->remaining);
+}
+
+/**
+ * Look up the state with hash `hash` in the transposition table, adding its
+ * count and returning true if present.
+ */
+static bool_t tt_lookup(search_t* search, board_hash_t hash) {
+    search_tt_t* tt = search->tt;
+    const search_tt_entry_t* entry = &tt->entries[hash & tt->mask];
+
+    if (entry->count < 0 || entry->hash != hash) {
+        return FALSE;
+    }
+
+    search->count += entry->count;
+    tt->hits++;
+    return TRUE;
+}
+
+/**
+ * Record the count of the subtree below `frame`, which has been fully explored.
+ */
+static void tt_store(search_t* search, const search_frame_t* frame) {
+    search_tt_entry_t* entry;
+
+    if (frame->count_mark < 0) {
+        return;
+    }
+
+    entry = &search->tt->entries[frame->hash & search->tt->mask];
+    entry->hash = frame->hash;
+    entry->count = search->count - frame->count_mark;
+}
+
+void search_init(search_t* search, const board_t* board) {
+    int block_size = board_block_size(board);
+    int cell_count = block_size * block_size;
+    int words = BITSET_WORDS(block_size);
+    int idx;
+
+    search->geom = geometry_acquire(board->m, board->n,
+                                    board_get_layout(board));
+    search->block_size = block_size;
+    search->words = words;
+
+    search->values = checked_calloc(cell_count, sizeof(int));
+    search->unit_masks =
+        checked_calloc(UK_COUNT * block_size * words, sizeof(bitset_word_t));
+    search->empty_count = 0;
+    search->hash = board_hash(board);
+
+    search->trail = checked_calloc(cell_count, sizeof(int));
+    search->trail_size = 0;
+
+    /* The bitsets of all frames share a single allocation, owned by the first
+     * frame. */
+    search->frames = checked_calloc(cell_count, sizeof(search_frame_t));
+    search->frames[0].remaining =
+        checked_calloc(cell_count * words, sizeof(bitset_word_t));
+    search->depth = 0;
+    for (idx = 1; idx < cell_count; idx++) {
+        search->frames[idx].remaining =
+            &search->frames[0].remaining[idx * words];
+    }
+
+    search->conflicted = board_has_conflicts(board);
+
+    search->count = 0;
+    search->nodes = 0;
+    search->base_mark = 0;
+    search->base_depth = 0;
+
+    search->tt = NULL;
+
+    search->full = checked_calloc(words, sizeof(bitset_word_t));
+    search->cand = checked_calloc(words, sizeof(bitset_word_t));
+    search->once = checked_calloc(words, sizeof(bitset_word_t));
+    search->twice = checked_calloc(words, sizeof(bitset_word_t));
+    bitset_fill(search->full, block_size);
+
+    memcpy(search->unit_masks, board->unit_masks,
+           UK_COUNT * block_size * words * sizeof(bitset_word_t));
+    for (idx = 0; idx < cell_count; idx++) {
+        search->values[idx] = board_get_value_at(board, idx);
+        if (!search->values[idx]) {
+            search->empty_count++;
+        }
+    }
+}
+
+void search_destroy(search_t* search) {
+    free(search->twice);
+    free(search->once);
+    free(search->cand);
+    free(search->full);
+
+    free(search->frames[0].remaining);
+    free(search->frames);
+    free(search->trail);
+
+    free(search->unit_masks);
+    free(search->values);
+
+    geometry_release(search->geom);
+}
+
+void search_tt_init(search_tt_t* tt, int bits) {
+    unsigned long size = 1UL << bits;
+
+    tt->entries = checked_calloc(size, sizeof(search_tt_entry_t));
+    tt->mask = size - 1;
+    search_tt_clear(tt);
+}
+
+void search_tt_destroy(search_tt_t* tt) { free(tt->entries); }
+
+void search_tt_clear(search_tt_t* tt) {
+    unsigned long i;
+
+    for (i = 0; i <= tt->mask; i++) {
+        tt->entries[i].count = -1;
+    }
+    tt->hits = 0;
+}
+
+void search_set_tt(search_t* search, search_tt_t* tt) { search->tt = tt; }
+
+void search_reset(search_t* search) {
+    undo_to(search, 0);
+    search->depth = 0;
+}
+
+bool_t search_propagate(search_t* search, int* best) {
+    if (search->conflicted) {
+        return FALSE;
+    }
+    return propagate(search, best);
+}
+
+bool_t search_place(search_t* search, int cell, int value) {
+    int best;
+
+    if (search->values[cell] || !search_has_candidate(search, cell, value)) {
+        return FALSE;
+    }
+
+    assign(search, cell, value);
+    return search_propagate(search, &best);
+}
+
+bool_t search_has_candidate(const search_t* search, int cell, int value) {
+    const int* units = geometry_cell_units(search->geom, cell);
+    int kind;
+
+    for (kind = 0; kind < UK_COUNT; kind++) {
+        if (BITSET_TEST(unit_mask(search, units[kind]), value - 1)) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+int search_candidates(const search_t* search, int cell,
+                      bitset_word_t* candidates) {
+    return cell_candidates(search, cell, candidates);
+}
+
+long search_count(search_t* search) { return search_count_limit(search, 0); }
+
+long search_count_limit(search_t* search, int limit) {
+    search_begin(search);
+    search_resume(search, limit, 0);
+    return limit && search->count > limit ? limit : search->count;
+}
+
+void search_begin(search_t* search) {
+    int best;
+
+    search->count = 0;
+    search->nodes = 0;
+    search->base_mark = search->trail_size;
+    search->base_depth = search->depth;
+
+    if (!search_propagate(search, &best)) {
+        undo_to(search, search->base_mark);
+        return;
+    }
+
+    if (best == -1) {
+        search->count++;
+    } else {
+        push_frame(search, best);
+    }
+}
+
+bool_t search_resume(search_t* search, int limit, long max_nodes) {
+    long nodes = 0;
+    int best;
+
+    while (search->depth > search->base_depth &&
+           (!limit || search->count < limit)) {
+        search_frame_t* frame = &search->frames[search->depth - 1];
+        int bit;
+
+        if (max_nodes && nodes == max_nodes) {
+            return FALSE;
+        }
+
+        bit = bitset_next(frame->remaining, search->words, 0);
+        undo_to(search, frame->trail_mark);
+
+        if (bit == -1) {
+            /* Every value has been tried here - backtrack. */
+            if (search->tt) {
+                tt_store(search, frame);
+            }
+            search->depth--;
+            continue;
+        }
+
+        BITSET_CLEAR(frame->remaining, bit);
+        frame->value = bit + 1;
+        assign(search, frame->cell, frame->value);
+        nodes++;
+        search->nodes++;
+
+        if (!propagate(search, &best)) {
+            continue;
+        }
+
+        if (best == -1) {
+            search->count++;
+        } else if (!search->tt || !tt_lookup(search, search->hash)) {
+            push_frame(search, best);
+        }
+    }
+
+    /* Leave the search as it was, so that it can be run again. */
+    undo_to(search, search->base_mark);
+    search->depth = search->base_depth;
+
+    return TRUE;
+}
+
+bool_t search_restore(search_t* search, long count, long nodes, int depth,
+                      const int* cells, const int* values,
+                      const bitset_word_t* remaining) {
+    int i;
+
+    search_begin(search);
+
+    /* The first frame is rebuilt by `search_begin` itself. */
+    if (search->depth != search->base_depth + (depth > 0)) {
+        return FALSE;
+    }
+
+    for (i = 0; i < depth; i++) {
+        search_frame_t* frame;
+        int best;
+
+        if (i > 0) {
+            if (search->depth == search->geom->cell_count ||
+                search->values[cells[i]]) {
+                return FALSE;
+            }
+            push_frame(search, cells[i]);
+        }
+
+        frame = &search->frames[search->depth - 1];
+        if (frame->cell != cells[i]) {
+            return FALSE;
+        }
+
+        memcpy(frame->remaining, &remaining[i * search->words],
+               search->words * sizeof(bitset_word_t));
+
+        if (!values[i]) {
+            if (i != depth - 1) {
+                return FALSE;
+            }
+            continue;
+        }
+
+        if (!search_has_candidate(search, cells[i], values[i])) {
+            return FALSE;
+        }
+
+        frame->value = values[i];
+        assign(search, cells[i], values[i]);
+
+        /* Only the deepest frame's value may lead to a contradiction. */
+        if (!propagate(search, &best) && i != depth - 1) {
+            return FALSE;
+        }
+    }
+
+    /* Part of every restored subtree was counted before the checkpoint. */
+    for (i = search->base_depth; i < search->depth; i++) {
+        search->frames[i].count_mark = -1;
+    }
+
+    search->count = count;
+    search->nodes = nodes;
+    return TRUE;
+}
@@ -0,0 +1,219 @@
+/**
+ * search.h - Bitmask-based exhaustive search with constraint propagation.
+ */
+
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "bitset.h"
+#include "board.h"
+#include "bool.h"
+#include "geometry.h"
+
+/**
+ * A branching point in the search: the cell being branched on and the values
+ * that remain to be tried there.
+ */
+typedef struct search_frame {
+    int cell;
+    int value;                /* Value being explored, or 0 if none yet */
+    int trail_mark;           /* Trail size to restore before every branch */
+    bitset_word_t* remaining; /* Values not yet tried, as a bitset */
+    board_hash_t hash;        /* Hash of the values when the frame was pushed */
+    long count_mark; /* Count when the frame was pushed, or -1 if unknown */
+} search_frame_t;
+
+/**
+ * A transposition table entry: the number of solutions below a state reached
+ * earlier in the search.
+ */
+typedef struct search_tt_entry {
+    board_hash_t hash;
+    long count; /* -1 for unused entries */
+} search_tt_entry_t;
+
+/**
+ * A bounded transposition table, mapping the hashes of states (see
+ * `board_hash`) to the number of solutions below them. Tables can be shared
+ * between searches over boards of the same dimensions and layout, but not
+ * between searches running concurrently.
+ */
+typedef struct search_tt {
+    search_tt_entry_t* entries; /* Indexed by the low bits of the hash */
+    unsigned long mask;
+    long hits;
+} search_tt_t;
+
+/**
+ * Default number of transposition table entries, as a power of 2.
+ */
+#define SEARCH_TT_DEFAULT_BITS 16
+
+/**
+ * Search state over a copy of a board. All storage is allocated up front:
+ * placing a value and undoing placements never allocate.
+ */
+typedef struct search {
+    const geometry_t* geom;
+    int block_size;
+    int words; /* Number of words in each value bitset */
+
+    int* values;               /* Current value of every cell */
+    bitset_word_t* unit_masks; /* Values placed in every unit */
+    int empty_count;
+    board_hash_t hash; /* Zobrist hash of `values` (see `board_hash`) */
+
+    /* Cells assigned since the search began, in order of assignment. */
+    int* trail;
+    int trail_size;
+
+    /* Stack of branching points, with room for one per cell. */
+    search_frame_t* frames;
+    int depth;
+
+    /* True if the initial board had conflicting cells. */
+    bool_t conflicted;
+
+    /* Progress of the current count (see `search_begin`). */
+    long count;
+    long nodes;     /* Number of values tried so far */
+    int base_mark;  /* Trail size when the count began */
+    int base_depth; /* Frame depth when the count began */
+
+    /* Optional transposition table, not owned by the search. */
+    search_tt_t* tt;
+
+    /* Scratch bitsets. */
+    bitset_word_t* full;
+    bitset_word_t* cand;
+    bitset_word_t* once;
+    bitset_word_t* twice;
+} search_t;
+
+/**
+ * Initialize a search over the current contents of `board`. The board itself
+ * is not referenced after this function returns.
+ */
+void search_init(search_t* search, const board_t* board);
+
+/**
+ * Destroy `search`, releasing any allocated resources.
+ */
+void search_destroy(search_t* search);
+
+/**
+ * Initialize an empty transposition table of `1 << bits` entries.
+ */
+void search_tt_init(search_tt_t* tt, int bits);
+
+/**
+ * Destroy `tt`, releasing any allocated resources.
+ */
+void search_tt_destroy(search_tt_t* tt);
+
+/**
+ * Remove every entry from `tt`, such as before reusing it for boards of
+ * different dimensions.
+ */
+void search_tt_clear(search_tt_t* tt);
+
+/**
+ * Make `search` use the transposition table `tt` (or none, if NULL). Whenever
+ * a subtree has been fully counted, its count is stored under the hash of the
+ * state at its root, replacing any previous entry in the same slot. Branches
+ * reaching a state with a stored count add it instead of searching again.
+ *
+ * Within a single count every state is reached at most once, since branches
+ * differ in the value of their branching cell. Hits come from later counts
+ * sharing the table, such as counts of the same board after further cells
+ * have been filled in.
+ */
+void search_set_tt(search_t* search, search_tt_t* tt);
+
+/**
+ * Count the solutions of the board the search was initialized with, under any
+ * values placed with `search_place`. Boards that already contain conflicts have
+ * no solutions.
+ *
+ * At every node, naked and hidden singles are propagated before branching on
+ * the empty cell with the fewest candidates. The search is left in the state
+ * it was in before the call.
+ */
+long search_count(search_t* search);
+
+/**
+ * Like `search_count`, but stop as soon as `limit` solutions have been found,
+ * returning `limit`. A `limit` of 0 means no limit.
+ *
+ * With a transposition table, `search->count` may overshoot `limit`, but the
+ * returned count never does.
+ */
+long search_count_limit(search_t* search, int limit);
+
+/**
+ * Begin counting solutions incrementally: propagate from the current state and
+ * set up the first branching point. `search->count` holds the number of
+ * solutions found so far, and the frames in `[0, depth)` describe the part of
+ * the search tree yet to be explored.
+ */
+void search_begin(search_t* search);
+
+/**
+ * Continue a count started by `search_begin`, trying at most `max_nodes`
+ * values (or any number of values if `max_nodes` is 0), and stopping once
+ * `limit` solutions have been found (unless `limit` is 0).
+ *
+ * Returns true once the count has finished, in which case the search is left
+ * in the state it was in before `search_begin`. Otherwise, the count can be
+ * continued with another call.
+ */
+bool_t search_resume(search_t* search, int limit, long max_nodes);
+
+/**
+ * Rebuild an interrupted count on a freshly-initialized search (as if by
+ * `search_begin`, then `search_resume`), given its progress and the `depth`
+ * frames of its frontier, from the shallowest: the cell each frame branches
+ * on, the value being explored there (0 if none yet) and the untried values
+ * (`words` words per frame, consecutively). The count can then be continued
+ * with `search_resume`.
+ *
+ * Returns false if the frames are not consistent with the board, in which
+ * case the search should be destroyed.
+ */
+bool_t search_restore(search_t* search, long count, long nodes, int depth,
+                      const int* cells, const int* values,
+                      const bitset_word_t* remaining);
+
+/**
+ * Undo every placement made since the search was initialized.
+ */
+void search_reset(search_t* search);
+
+/**
+ * Propagate singles from the current state. Returns false if a contradiction
+ * is found. Otherwise, `*best` receives the empty cell with the fewest
+ * candidates, or -1 if every cell is filled.
+ */
+bool_t search_propagate(search_t* search, int* best);
+
+/**
+ * Place `value` in the empty cell `cell` and propagate its consequences.
+ * Returns false if the value is not a candidate of the cell or leads to a
+ * contradiction, in which case the search should be reset.
+ */
+bool_t search_place(search_t* search, int cell, int value);
+
+/**
+ * Check whether `value` can be placed in `cell` without conflicting with any
+ * filled cell.
+ */
+bool_t search_has_candidate(const search_t* search, int cell, int value);
+
+/**
+ * Compute the candidates of the empty cell `cell` into `candidates` (which
+ * should have room for `words` words), returning their number.
+ */
+int search_candidates(const search_t* search, int cell,
+                      bitset_word_t* candidates);
+
+#endif
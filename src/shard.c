@@ -0,0 +1,188 @@
+#include "shard.h"
+
+#include "bitset.h"
+#include "checked_alloc.h"
+#include "search.h"
+#include <stdlib.h>
+
+/**
+ * Replay `prefix` on `search` from scratch. Returns false if it leads to a
+ * contradiction.
+ */
+static bool_t replay(search_t* search, const shard_prefix_t* prefix) {
+    int i;
+
+    search_reset(search);
+
+    for (i = 0; i < prefix->depth; i++) {
+        if (!search_place(search, prefix->cells[i], prefix->values[i])) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+int shard_enumerate(const board_t* board, int min_count,
+                    shard_prefix_t** prefixes) {
+    search_t search;
+    bitset_word_t* candidates;
+
+    shard_prefix_t* level = checked_calloc(1, sizeof(shard_prefix_t));
+    int count = 1;
+    int depth;
+
+    search_init(&search, board);
+    candidates = checked_calloc(search.words, sizeof(bitset_word_t));
+
+    level[0].depth = 0;
+
+    for (depth = 0; count < min_count && depth < SHARD_MAX_DEPTH; depth++) {
+        shard_prefix_t* next = NULL;
+        int next_count = 0;
+        int capacity = 0;
+        bool_t expanded = FALSE;
+        int i;
+
+        for (i = 0; i < count; i++) {
+            const shard_prefix_t* prefix = &level[i];
+            int best;
+            int bit;
+
+            if (!replay(&search, prefix) || !search_propagate(&search, &best)) {
+                continue;
+            }
+
+            if (next_count + search.block_size > capacity) {
+                capacity = 2 * capacity + search.block_size;
+                next = checked_realloc(next, capacity * sizeof(shard_prefix_t));
+            }
+
+            /* Solved prefixes have nothing left to split. */
+            if (best == -1) {
+                next[next_count++] = *prefix;
+                continue;
+            }
+
+            search_candidates(&search, best, candidates);
+            for (bit = bitset_next(candidates, search.words, 0); bit != -1;
+                 bit = bitset_next(candidates, search.words, bit + 1)) {
+                shard_prefix_t* child = &next[next_count++];
+
+                *child = *prefix;
+                child->cells[child->depth] = best;
+                child->values[child->depth] = bit + 1;
+                child->depth++;
+            }
+            expanded = TRUE;
+        }
+
+        free(level);
+        level = next;
+        count = next_count;
+
+        if (!expanded) {
+            break;
+        }
+    }
+
+    free(candidates);
+    search_destroy(&search);
+
+    *prefixes = level;
+    return count;
+}
+
+long shard_count(const board_t* board, int index, int total) {
+    search_t search;
+    shard_prefix_t* prefixes;
+    int prefix_count;
+    long count = 0;
+    int i;
+
+    prefix_count =
+        shard_enumerate(board, total * SHARD_PREFIXES_PER_SHARD, &prefixes);
+
+    search_init(&search, board);
+
+    for (i = index; i < prefix_count; i += total) {
+        if (replay(&search, &prefixes[i])) {
+            count += search_count(&search);
+        }
+    }
+
+    search_destroy(&search);
+    free(prefixes);
+
+    return count;
+}
+
+void shard_print_result(FILE* stream, int index, int total, long count) {
+    fprintf(stream, "shard %d/%d count %ld\n", index, total, count);
+}
+
+void shard_merge_init(shard_merge_t* merge) {
+    merge->total = 0;
+    merge->seen = NULL;
+    merge->seen_count = 0;
+    merge->count = 0;
+}
+
+void shard_merge_destroy(shard_merge_t* merge) {
+    free(merge->seen);
+}
+
+/**
+ * Add the result of shard `index` of `total` to `merge`.
+ */
+static shard_merge_status_t merge_add(shard_merge_t* merge, int index,
+                                      int total, long count) {
+    if (total <= 0 || index < 0 || index >= total || count < 0) {
+        return SM_ERR_FMT;
+    }
+
+    if (!merge->total) {
+        merge->total = total;
+        merge->seen = checked_calloc(total, sizeof(bool_t));
+    } else if (merge->total != total) {
+        return SM_ERR_MISMATCH;
+    }
+
+    if (merge->seen[index]) {
+        return SM_ERR_DUPLICATE;
+    }
+
+    merge->seen[index] = TRUE;
+    merge->seen_count++;
+    merge->count += count;
+
+    return SM_OK;
+}
+
+shard_merge_status_t shard_merge_read(shard_merge_t* merge, FILE* stream) {
+    int index, total;
+    long count;
+    int read;
+
+    while ((read = fscanf(stream, " shard %d/%d count %ld", &index, &total,
+                          &count)) == 3) {
+        shard_merge_status_t status = merge_add(merge, index, total, count);
+
+        if (status != SM_OK) {
+            return status;
+        }
+    }
+
+    /* Anything other than a clean end of input is malformed. */
+    return read == EOF && !ferror(stream) ? SM_OK : SM_ERR_FMT;
+}
+
+shard_merge_status_t shard_merge_finish(const shard_merge_t* merge,
+                                        long* count) {
+    if (!merge->total || merge->seen_count < merge->total) {
+        return SM_ERR_MISSING;
+    }
+
+    *count = merge->count;
+    return SM_OK;
+}
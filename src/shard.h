@@ -0,0 +1,101 @@
+/**
+ * shard.h - Splitting solution counts into independently-run shards.
+ */
+
+#ifndef SHARD_H
+#define SHARD_H
+
+#include "board.h"
+#include "bool.h"
+#include <stdio.h>
+
+/**
+ * Maximum number of decisions leading to a shard prefix.
+ */
+#define SHARD_MAX_DEPTH 16
+
+/**
+ * Number of prefixes to aim for per shard, so that shards of uneven difficulty
+ * even out.
+ */
+#define SHARD_PREFIXES_PER_SHARD 8
+
+/**
+ * A subtree of the search, reached by placing `values[i]` in `cells[i]` for
+ * every `i` in `[0, depth)` (propagating after each placement).
+ */
+typedef struct shard_prefix {
+    int depth;
+    int cells[SHARD_MAX_DEPTH];
+    int values[SHARD_MAX_DEPTH];
+} shard_prefix_t;
+
+/**
+ * Split the search tree of `board` into at least `min_count` disjoint prefixes
+ * (fewer if the tree is too small or `SHARD_MAX_DEPTH` is reached), following
+ * the branching order of `num_solutions`. Prefixes are expanded a level at a
+ * time, so the result depends only on the board and `min_count`.
+ *
+ * Returns the number of prefixes, which are stored in a newly-allocated array
+ * in `*prefixes`. The caller is responsible for freeing it.
+ */
+int shard_enumerate(const board_t* board, int min_count,
+                    shard_prefix_t** prefixes);
+
+/**
+ * Count the solutions of `board` within shard `index` of `total`: the prefixes
+ * enumerated for `total * SHARD_PREFIXES_PER_SHARD` whose position is `index`
+ * modulo `total`. The counts of all `total` shards sum to `num_solutions`.
+ */
+long shard_count(const board_t* board, int index, int total);
+
+/**
+ * Status code returned when merging shard results.
+ */
+typedef enum shard_merge_status {
+    SM_OK,
+    SM_ERR_FMT,       /* A result line is malformed */
+    SM_ERR_MISMATCH,  /* Results split the count into different numbers */
+    SM_ERR_DUPLICATE, /* A shard was reported twice */
+    SM_ERR_MISSING    /* Some shards were never reported */
+} shard_merge_status_t;
+
+/**
+ * Accumulates the results of the shards of a single count.
+ */
+typedef struct shard_merge {
+    int total;    /* Number of shards, or 0 before the first result */
+    bool_t* seen; /* Whether each shard has been reported */
+    int seen_count;
+    long count;
+} shard_merge_t;
+
+/**
+ * Print the result of shard `index` of `total` to `stream`, in the format read
+ * by `shard_merge_read`.
+ */
+void shard_print_result(FILE* stream, int index, int total, long count);
+
+/**
+ * Initialize an empty merge.
+ */
+void shard_merge_init(shard_merge_t* merge);
+
+/**
+ * Destroy `merge`, releasing any allocated resources.
+ */
+void shard_merge_destroy(shard_merge_t* merge);
+
+/**
+ * Add every shard result in `stream` to `merge`, stopping at the first error.
+ */
+shard_merge_status_t shard_merge_read(shard_merge_t* merge, FILE* stream);
+
+/**
+ * Check that every shard has been reported, storing the total count in
+ * `*count` if so.
+ */
+shard_merge_status_t shard_merge_finish(const shard_merge_t* merge,
+                                        long* count);
+
+#endif
@@ -0,0 +1,738 @@
+#include "simplex.h"
+
+#include "bool.h"
+#include "checked_alloc.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Solver state. Variables `[0, cols)` are those of the problem, and variable
+ * `cols + i` is the artificial variable of row `i`, whose column is
+ * `signs[i]` times the `i`-th unit vector.
+ *
+ * The basis inverse is kept in product form, as the inverse of the initial
+ * basis of artificial variables (which is its own inverse) followed by an eta
+ * file. Eta vector `k` describes a pivot on row `eta_row[k]`: applying it to a
+ * vector `v` divides `v[eta_row[k]]` by the pivot element, then adds the
+ * result times `eta_values[p]` to `v[eta_index[p]]` for every `p` in
+ * `[eta_start[k], eta_start[k + 1])`.
+ */
+typedef struct simplex {
+    int rows;
+    int cols;
+    int vars;
+
+    /* The constraint matrix by columns. */
+    int* col_start;
+    int* col_rows;
+    double* col_values;
+
+    const double* rhs;
+    double* signs;
+
+    double* cost;  /* Cost of every variable in the current phase */
+    double* upper; /* Upper bound of every variable in the current phase */
+    double* x;     /* Value of every variable */
+
+    int* head;        /* Basic variable of every row */
+    int* basis_row;   /* Row of every basic variable, or -1 if nonbasic */
+    bool_t* at_upper; /* Set for nonbasic variables at their upper bound */
+
+    int eta_count;
+    int eta_capacity;
+    int* eta_row;
+    double* eta_pivot; /* Reciprocal of the pivot element of every eta */
+    int* eta_start;
+    int nonzero_capacity;
+    int* eta_index;
+    double* eta_values;
+    int factor_etas; /* Number of etas when the basis was last refactored */
+
+    double* duals; /* Simplex multipliers: basic costs times the inverse */
+    double* alpha; /* The entering column in terms of the basis */
+    double* rho;   /* Row of the basis inverse of the leaving variable */
+    double* weights; /* Devex reference weights of every variable */
+    double* work;
+    int* basic; /* Scratch for refactoring */
+    bool_t* keep;
+
+    long iterations;
+    long max_iterations;
+} simplex_t;
+
+/**
+ * Store the columns of `problem` to `simplex`.
+ */
+static void transpose(simplex_t* simplex, const simplex_problem_t* problem) {
+    int nonzeros = problem->row_start[problem->rows];
+    int* fill;
+    int i, k;
+
+    simplex->col_start = checked_calloc(problem->cols + 1, sizeof(int));
+    simplex->col_rows = checked_calloc(nonzeros + 1, sizeof(int));
+    simplex->col_values = checked_calloc(nonzeros + 1, sizeof(double));
+
+    for (k = 0; k < nonzeros; k++) {
+        simplex->col_start[problem->row_cols[k] + 1]++;
+    }
+    for (i = 0; i < problem->cols; i++) {
+        simplex->col_start[i + 1] += simplex->col_start[i];
+    }
+
+    fill = checked_calloc(problem->cols, sizeof(int));
+    memcpy(fill, simplex->col_start, problem->cols * sizeof(int));
+
+    for (i = 0; i < problem->rows; i++) {
+        for (k = problem->row_start[i]; k < problem->row_start[i + 1]; k++) {
+            int pos = fill[problem->row_cols[k]]++;
+
+            simplex->col_rows[pos] = i;
+            simplex->col_values[pos] =
+                problem->row_values ? problem->row_values[k] : 1.0;
+        }
+    }
+
+    free(fill);
+}
+
+static void simplex_init(simplex_t* simplex, const simplex_problem_t* problem) {
+    int rows = problem->rows;
+    int vars = problem->cols + rows;
+    int i;
+
+    simplex->rows = rows;
+    simplex->cols = problem->cols;
+    simplex->vars = vars;
+    simplex->rhs = problem->rhs;
+
+    transpose(simplex, problem);
+
+    simplex->signs = checked_calloc(rows + 1, sizeof(double));
+    simplex->cost = checked_calloc(vars, sizeof(double));
+    simplex->upper = checked_calloc(vars, sizeof(double));
+    simplex->x = checked_calloc(vars, sizeof(double));
+    simplex->head = checked_calloc(rows + 1, sizeof(int));
+    simplex->basis_row = checked_calloc(vars, sizeof(int));
+    simplex->at_upper = checked_calloc(vars, sizeof(bool_t));
+    simplex->duals = checked_calloc(rows + 1, sizeof(double));
+    simplex->alpha = checked_calloc(rows + 1, sizeof(double));
+    simplex->rho = checked_calloc(rows + 1, sizeof(double));
+    simplex->weights = checked_calloc(vars, sizeof(double));
+    simplex->work = checked_calloc(rows + 1, sizeof(double));
+    simplex->basic = checked_calloc(rows + 1, sizeof(int));
+    simplex->keep = checked_calloc(rows + 1, sizeof(bool_t));
+
+    simplex->eta_count = 0;
+    simplex->eta_capacity = rows + SIMPLEX_REFACTOR_INTERVAL;
+    simplex->eta_row = checked_calloc(simplex->eta_capacity, sizeof(int));
+    simplex->eta_pivot = checked_calloc(simplex->eta_capacity, sizeof(double));
+    simplex->eta_start = checked_calloc(simplex->eta_capacity + 1, sizeof(int));
+    simplex->nonzero_capacity = 16 * simplex->eta_capacity;
+    simplex->eta_index = checked_calloc(simplex->nonzero_capacity, sizeof(int));
+    simplex->eta_values =
+        checked_calloc(simplex->nonzero_capacity, sizeof(double));
+    simplex->factor_etas = 0;
+
+    simplex->iterations = 0;
+    simplex->max_iterations = 100L * vars + 1000;
+
+    /* Start from the basis of artificial variables, with every problem
+     * variable at its lower bound. */
+    memcpy(simplex->upper, problem->upper, problem->cols * sizeof(double));
+    for (i = 0; i < problem->cols; i++) {
+        simplex->basis_row[i] = -1;
+    }
+
+    for (i = 0; i < rows; i++) {
+        int var = problem->cols + i;
+
+        simplex->signs[i] = problem->rhs[i] < 0 ? -1.0 : 1.0;
+        simplex->upper[var] = HUGE_VAL;
+        simplex->x[var] = fabs(problem->rhs[i]);
+        simplex->head[i] = var;
+        simplex->basis_row[var] = i;
+    }
+}
+
+static void simplex_destroy(simplex_t* simplex) {
+    free(simplex->eta_values);
+    free(simplex->eta_index);
+    free(simplex->eta_start);
+    free(simplex->eta_pivot);
+    free(simplex->eta_row);
+    free(simplex->keep);
+    free(simplex->basic);
+    free(simplex->work);
+    free(simplex->weights);
+    free(simplex->rho);
+    free(simplex->alpha);
+    free(simplex->duals);
+    free(simplex->at_upper);
+    free(simplex->basis_row);
+    free(simplex->head);
+    free(simplex->x);
+    free(simplex->upper);
+    free(simplex->cost);
+    free(simplex->signs);
+    free(simplex->col_values);
+    free(simplex->col_rows);
+    free(simplex->col_start);
+}
+
+/**
+ * Compute the dot product of `vec` (indexed by row) with the column of `var`.
+ */
+static double column_dot(const simplex_t* simplex, const double* vec,
+                         int var) {
+    double sum = 0.0;
+    int k;
+
+    if (var >= simplex->cols) {
+        int row = var - simplex->cols;
+        return vec[row] * simplex->signs[row];
+    }
+
+    for (k = simplex->col_start[var]; k < simplex->col_start[var + 1]; k++) {
+        sum += vec[simplex->col_rows[k]] * simplex->col_values[k];
+    }
+
+    return sum;
+}
+
+/**
+ * Add `scale` times the column of `var` to `vec` (indexed by row).
+ */
+static void column_axpy(const simplex_t* simplex, double* vec, int var,
+                        double scale) {
+    int k;
+
+    if (var >= simplex->cols) {
+        int row = var - simplex->cols;
+        vec[row] += scale * simplex->signs[row];
+        return;
+    }
+
+    for (k = simplex->col_start[var]; k < simplex->col_start[var + 1]; k++) {
+        vec[simplex->col_rows[k]] += scale * simplex->col_values[k];
+    }
+}
+
+/**
+ * Multiply `vec` (indexed by row) by the basis inverse from the left, in place.
+ */
+static void ftran(const simplex_t* simplex, double* vec) {
+    int i, k, p;
+
+    for (i = 0; i < simplex->rows; i++) {
+        vec[i] *= simplex->signs[i];
+    }
+
+    for (k = 0; k < simplex->eta_count; k++) {
+        int row = simplex->eta_row[k];
+        double value = vec[row];
+
+        if (value == 0.0) {
+            continue;
+        }
+
+        value *= simplex->eta_pivot[k];
+        vec[row] = value;
+        for (p = simplex->eta_start[k]; p < simplex->eta_start[k + 1]; p++) {
+            vec[simplex->eta_index[p]] += simplex->eta_values[p] * value;
+        }
+    }
+}
+
+/**
+ * Multiply `vec` (indexed by basis position) by the basis inverse from the
+ * right, in place.
+ */
+static void btran(const simplex_t* simplex, double* vec) {
+    int i, k, p;
+
+    for (k = simplex->eta_count - 1; k >= 0; k--) {
+        int row = simplex->eta_row[k];
+        double sum = vec[row];
+
+        for (p = simplex->eta_start[k]; p < simplex->eta_start[k + 1]; p++) {
+            sum += simplex->eta_values[p] * vec[simplex->eta_index[p]];
+        }
+        vec[row] = sum * simplex->eta_pivot[k];
+    }
+
+    for (i = 0; i < simplex->rows; i++) {
+        vec[i] *= simplex->signs[i];
+    }
+}
+
+/**
+ * Recompute the values of the basic variables and the simplex multipliers from
+ * the basis inverse.
+ */
+static void refresh(simplex_t* simplex) {
+    int rows = simplex->rows;
+    double* residual = simplex->work;
+    int i, var;
+
+    memcpy(residual, simplex->rhs, rows * sizeof(double));
+    for (var = 0; var < simplex->vars; var++) {
+        if (simplex->basis_row[var] == -1 && simplex->x[var] != 0.0) {
+            column_axpy(simplex, residual, var, -simplex->x[var]);
+        }
+    }
+
+    ftran(simplex, residual);
+    for (i = 0; i < rows; i++) {
+        simplex->x[simplex->head[i]] = residual[i];
+    }
+
+    for (i = 0; i < rows; i++) {
+        simplex->duals[i] = simplex->cost[simplex->head[i]];
+    }
+    btran(simplex, simplex->duals);
+}
+
+/**
+ * Compute the largest violation of the constraints by the current values of
+ * the variables, which grows with the error in the basis inverse.
+ */
+static double constraint_error(simplex_t* simplex) {
+    double* residual = simplex->work;
+    double error = 0.0;
+    int i, var;
+
+    memcpy(residual, simplex->rhs, simplex->rows * sizeof(double));
+    for (var = 0; var < simplex->vars; var++) {
+        if (simplex->x[var] != 0.0) {
+            column_axpy(simplex, residual, var, -simplex->x[var]);
+        }
+    }
+
+    for (i = 0; i < simplex->rows; i++) {
+        if (fabs(residual[i]) > error) {
+            error = fabs(residual[i]);
+        }
+    }
+
+    return error;
+}
+
+/**
+ * Compute `alpha`, the column of `var` in terms of the current basis.
+ */
+static void compute_alpha(simplex_t* simplex, int var) {
+    memset(simplex->alpha, 0, simplex->rows * sizeof(double));
+    column_axpy(simplex, simplex->alpha, var, 1.0);
+    ftran(simplex, simplex->alpha);
+}
+
+/**
+ * Compute `rho`, the row of the basis inverse belonging to basis position
+ * `leaving`.
+ */
+static void compute_rho(simplex_t* simplex, int leaving) {
+    memset(simplex->rho, 0, simplex->rows * sizeof(double));
+    simplex->rho[leaving] = 1.0;
+    btran(simplex, simplex->rho);
+}
+
+/**
+ * Choose a nonbasic variable whose move away from its bound improves the
+ * objective, storing its reduced cost to `*reduced`. Returns -1 if there is
+ * none, meaning the basis is optimal.
+ *
+ * Variables are scored by their squared reduced cost over their Devex weight,
+ * approximating the steepest edge, unless `bland` is set.
+ */
+static int choose_entering(const simplex_t* simplex, bool_t bland,
+                           double* reduced) {
+    int best = -1;
+    double best_score = -1.0;
+    int var;
+
+    for (var = 0; var < simplex->vars; var++) {
+        double d;
+
+        if (simplex->basis_row[var] != -1 ||
+            simplex->upper[var] <= SIMPLEX_TOLERANCE) {
+            continue;
+        }
+
+        d = simplex->cost[var] - column_dot(simplex, simplex->duals, var);
+        if (simplex->at_upper[var] ? d > SIMPLEX_TOLERANCE
+                                   : d < -SIMPLEX_TOLERANCE) {
+            double score = d * d / simplex->weights[var];
+
+            if (score > best_score) {
+                best = var;
+                best_score = score;
+                *reduced = d;
+
+                if (bland) {
+                    break;
+                }
+            }
+        }
+    }
+
+    return best;
+}
+
+/**
+ * Compute how far the basic variable of row `i` lets the entering variable move
+ * in direction `dir`, with its bounds relaxed by `slack`. Returns -1 if it does
+ * not block the move, or if its pivot would be too small to use safely.
+ */
+static double row_room(const simplex_t* simplex, int i, double dir,
+                       double slack) {
+    double a = simplex->alpha[i] * dir;
+    int var = simplex->head[i];
+    double room;
+
+    if (a > SIMPLEX_PIVOT_TOLERANCE) {
+        room = (simplex->x[var] + slack) / a;
+    } else if (a < -SIMPLEX_PIVOT_TOLERANCE &&
+               simplex->upper[var] != HUGE_VAL) {
+        room = (simplex->upper[var] - simplex->x[var] + slack) / -a;
+    } else {
+        return -1.0;
+    }
+
+    return room > 0.0 ? room : 0.0;
+}
+
+/**
+ * Choose the basic variable to leave the basis when the entering variable moves
+ * in direction `dir`, where `limit` is the entering variable's own range.
+ * Returns its row, or -1 if the entering variable reaches its other bound
+ * first, storing the step length to `*step`.
+ *
+ * This is Harris' two-pass ratio test: the shortest step is first found with
+ * the bounds relaxed by the tolerance, and the row with the largest pivot is
+ * then chosen among those blocking within it (or the one with the smallest
+ * variable index under Bland's rule).
+ */
+static int choose_leaving(const simplex_t* simplex, double dir, double limit,
+                          bool_t bland, double* step) {
+    double shortest = limit;
+    int leaving = -1;
+    int i;
+
+    for (i = 0; i < simplex->rows; i++) {
+        double room = row_room(simplex, i, dir, SIMPLEX_TOLERANCE);
+
+        if (room >= 0.0 && room < shortest) {
+            shortest = room;
+        }
+    }
+
+    *step = limit;
+
+    for (i = 0; i < simplex->rows; i++) {
+        double room = row_room(simplex, i, dir, 0.0);
+
+        if (room < 0.0 || room > shortest) {
+            continue;
+        }
+
+        if (leaving == -1 ||
+            (bland ? simplex->head[i] < simplex->head[leaving]
+                   : fabs(simplex->alpha[i]) > fabs(simplex->alpha[leaving]))) {
+            leaving = i;
+            *step = room;
+        }
+    }
+
+    return leaving;
+}
+
+/**
+ * Reset every Devex weight to 1, making the current nonbasic variables the
+ * reference framework.
+ */
+static void reset_weights(simplex_t* simplex) {
+    int var;
+    for (var = 0; var < simplex->vars; var++) {
+        simplex->weights[var] = 1.0;
+    }
+}
+
+/**
+ * Update the Devex weights for a pivot on row `leaving`, before the basis
+ * inverse is updated, using the `rho` of that row. The weights are reset once
+ * they grow too large to remain accurate.
+ */
+static void update_weights(simplex_t* simplex, int leaving, int entering) {
+    const double* pivot_row = simplex->rho;
+    double pivot = simplex->alpha[leaving];
+    double weight = simplex->weights[entering];
+    int var;
+
+    if (weight > SIMPLEX_DEVEX_RESET) {
+        reset_weights(simplex);
+        return;
+    }
+
+    for (var = 0; var < simplex->vars; var++) {
+        double ratio;
+
+        if (simplex->basis_row[var] != -1 || var == entering ||
+            simplex->upper[var] <= SIMPLEX_TOLERANCE) {
+            continue;
+        }
+
+        ratio = column_dot(simplex, pivot_row, var) / pivot;
+        if (ratio * ratio * weight > simplex->weights[var]) {
+            simplex->weights[var] = ratio * ratio * weight;
+        }
+    }
+
+    weight /= pivot * pivot;
+    simplex->weights[simplex->head[leaving]] = weight > 1.0 ? weight : 1.0;
+}
+
+/**
+ * Append the eta vector of a pivot on row `leaving` of `alpha` to the eta
+ * file, keeping only the nonzeros of `alpha`.
+ */
+static void append_eta(simplex_t* simplex, int leaving) {
+    int k = simplex->eta_count;
+    int pos = simplex->eta_start[k];
+    int i;
+
+    if (k == simplex->eta_capacity) {
+        simplex->eta_capacity *= 2;
+        simplex->eta_row = checked_realloc(
+            simplex->eta_row, simplex->eta_capacity * sizeof(int));
+        simplex->eta_pivot = checked_realloc(
+            simplex->eta_pivot, simplex->eta_capacity * sizeof(double));
+        simplex->eta_start = checked_realloc(
+            simplex->eta_start, (simplex->eta_capacity + 1) * sizeof(int));
+    }
+
+    if (pos + simplex->rows > simplex->nonzero_capacity) {
+        while (pos + simplex->rows > simplex->nonzero_capacity) {
+            simplex->nonzero_capacity *= 2;
+        }
+        simplex->eta_index = checked_realloc(
+            simplex->eta_index, simplex->nonzero_capacity * sizeof(int));
+        simplex->eta_values = checked_realloc(
+            simplex->eta_values, simplex->nonzero_capacity * sizeof(double));
+    }
+
+    for (i = 0; i < simplex->rows; i++) {
+        if (i != leaving && simplex->alpha[i] != 0.0) {
+            simplex->eta_index[pos] = i;
+            simplex->eta_values[pos] = -simplex->alpha[i];
+            pos++;
+        }
+    }
+
+    simplex->eta_row[k] = leaving;
+    simplex->eta_pivot[k] = 1.0 / simplex->alpha[leaving];
+    simplex->eta_start[k + 1] = pos;
+    simplex->eta_count++;
+}
+
+/**
+ * Replace the basic variable of row `leaving` by `entering`, whose column in
+ * terms of the basis is `alpha`, updating the basis inverse.
+ */
+static void pivot(simplex_t* simplex, int leaving, int entering) {
+    append_eta(simplex, leaving);
+
+    simplex->basis_row[simplex->head[leaving]] = -1;
+    simplex->head[leaving] = entering;
+    simplex->basis_row[entering] = leaving;
+    simplex->at_upper[entering] = FALSE;
+}
+
+/**
+ * Rebuild the basis inverse from scratch, discarding accumulated rounding
+ * errors and the eta vectors of past pivots: starting from the basis of
+ * artificial variables, the problem variables of the current basis are pivoted
+ * back in one at a time, each on the row with its largest entry among those
+ * whose artificial variable is not in the current basis. Returns false if the
+ * basis has become numerically singular.
+ */
+static bool_t reinvert(simplex_t* simplex) {
+    int rows = simplex->rows;
+    int* basic = simplex->basic;
+    int basic_count = 0;
+    bool_t* keep = simplex->keep;
+    int i, j;
+
+    for (i = 0; i < rows; i++) {
+        int var = simplex->head[i];
+
+        if (var < simplex->cols) {
+            basic[basic_count++] = var;
+            simplex->basis_row[var] = -1;
+        }
+    }
+
+    for (i = 0; i < rows; i++) {
+        int var = simplex->cols + i;
+
+        keep[i] = simplex->basis_row[var] != -1;
+        simplex->head[i] = var;
+        simplex->basis_row[var] = i;
+    }
+
+    simplex->eta_count = 0;
+
+    for (j = 0; j < basic_count; j++) {
+        int best = -1;
+
+        compute_alpha(simplex, basic[j]);
+        for (i = 0; i < rows; i++) {
+            if (!keep[i] && simplex->head[i] >= simplex->cols &&
+                (best == -1 ||
+                 fabs(simplex->alpha[i]) > fabs(simplex->alpha[best]))) {
+                best = i;
+            }
+        }
+
+        if (best == -1 ||
+            fabs(simplex->alpha[best]) < SIMPLEX_PIVOT_TOLERANCE) {
+            return FALSE;
+        }
+        pivot(simplex, best, basic[j]);
+    }
+
+    simplex->factor_etas = simplex->eta_count;
+    return TRUE;
+}
+
+/**
+ * Run simplex iterations under the current costs and bounds until the basis is
+ * optimal.
+ */
+static simplex_status_t iterate(simplex_t* simplex) {
+    int rows = simplex->rows;
+    int degenerate = 0;
+
+    reset_weights(simplex);
+    refresh(simplex);
+
+    for (;;) {
+        bool_t bland = degenerate > SIMPLEX_DEGENERATE_LIMIT;
+        double reduced = 0.0;
+        double dir;
+        double step;
+        int entering;
+        int leaving;
+        int i;
+
+        if (simplex->iterations++ >= simplex->max_iterations) {
+            return SIMPLEX_ITERATION_LIMIT;
+        }
+        if (simplex->eta_count - simplex->factor_etas >=
+            SIMPLEX_REFACTOR_INTERVAL) {
+            if (!reinvert(simplex)) {
+                return SIMPLEX_NUMERICAL_ERROR;
+            }
+            refresh(simplex);
+        } else if (simplex->iterations % SIMPLEX_REFRESH_INTERVAL == 0) {
+            refresh(simplex);
+
+            if (constraint_error(simplex) > SIMPLEX_TOLERANCE) {
+                if (!reinvert(simplex)) {
+                    return SIMPLEX_NUMERICAL_ERROR;
+                }
+                refresh(simplex);
+            }
+        }
+
+        entering = choose_entering(simplex, bland, &reduced);
+        if (entering == -1) {
+            return SIMPLEX_OPTIMAL;
+        }
+
+        compute_alpha(simplex, entering);
+
+        dir = simplex->at_upper[entering] ? -1.0 : 1.0;
+        leaving = choose_leaving(simplex, dir, simplex->upper[entering], bland,
+                                 &step);
+        if (step == HUGE_VAL) {
+            return SIMPLEX_UNBOUNDED;
+        }
+
+        degenerate = step > SIMPLEX_TOLERANCE ? 0 : degenerate + 1;
+
+        simplex->x[entering] += dir * step;
+        for (i = 0; i < rows; i++) {
+            simplex->x[simplex->head[i]] -= dir * step * simplex->alpha[i];
+        }
+
+        if (leaving == -1) {
+            /* The entering variable moves between its bounds instead. */
+            simplex->at_upper[entering] = !simplex->at_upper[entering];
+            simplex->x[entering] =
+                simplex->at_upper[entering] ? simplex->upper[entering] : 0.0;
+        } else {
+            int var = simplex->head[leaving];
+            bool_t to_upper = simplex->alpha[leaving] * dir < 0;
+
+            compute_rho(simplex, leaving);
+            update_weights(simplex, leaving, entering);
+            for (i = 0; i < rows; i++) {
+                simplex->duals[i] +=
+                    reduced / simplex->alpha[leaving] * simplex->rho[i];
+            }
+            pivot(simplex, leaving, entering);
+            simplex->at_upper[var] = to_upper;
+            simplex->x[var] = to_upper ? simplex->upper[var] : 0.0;
+        }
+    }
+}
+
+simplex_status_t simplex_solve(const simplex_problem_t* problem, double* x) {
+    simplex_status_t ret;
+    simplex_t simplex;
+    double infeasibility = 0.0;
+    int i;
+
+    simplex_init(&simplex, problem);
+
+    /* Phase 1: minimize the sum of the artificial variables. */
+    for (i = 0; i < problem->rows; i++) {
+        simplex.cost[problem->cols + i] = 1.0;
+    }
+
+    ret = iterate(&simplex);
+    if (ret != SIMPLEX_OPTIMAL) {
+        goto cleanup;
+    }
+
+    for (i = 0; i < problem->rows; i++) {
+        infeasibility += simplex.x[problem->cols + i];
+    }
+    if (infeasibility > SIMPLEX_TOLERANCE * (problem->rows + 1)) {
+        ret = SIMPLEX_INFEASIBLE;
+        goto cleanup;
+    }
+
+    /* Phase 2: fix the artificial variables at zero and minimize the real
+     * objective. */
+    memcpy(simplex.cost, problem->cost, problem->cols * sizeof(double));
+    for (i = 0; i < problem->rows; i++) {
+        int var = problem->cols + i;
+
+        simplex.cost[var] = 0.0;
+        simplex.upper[var] = 0.0;
+        simplex.x[var] = 0.0;
+        simplex.at_upper[var] = FALSE;
+    }
+
+    ret = iterate(&simplex);
+    if (ret == SIMPLEX_OPTIMAL) {
+        memcpy(x, simplex.x, problem->cols * sizeof(double));
+    }
+
+cleanup:
+    simplex_destroy(&simplex);
+    return ret;
+}
@@ -0,0 +1,86 @@
+/**
+ * simplex.h - Bounded-variable revised simplex for sparse linear programs.
+ */
+
+#ifndef SIMPLEX_H
+#define SIMPLEX_H
+
+/**
+ * Tolerance used for feasibility and optimality tests.
+ */
+#define SIMPLEX_TOLERANCE 1e-9
+
+/**
+ * Smallest magnitude of a usable pivot element.
+ */
+#define SIMPLEX_PIVOT_TOLERANCE 1e-7
+
+/**
+ * Devex weight above which all weights are reset.
+ */
+#define SIMPLEX_DEVEX_RESET 1e6
+
+/**
+ * Number of successive pivots that do not improve the objective before the
+ * solver switches from Devex pricing to Bland's rule, which cannot cycle.
+ */
+#define SIMPLEX_DEGENERATE_LIMIT 1000
+
+/**
+ * Number of pivots between recomputations of the basic variables from scratch.
+ * The basis inverse is rebuilt at the same time if the recomputed values no
+ * longer satisfy the constraints to within the tolerance.
+ */
+#define SIMPLEX_REFRESH_INTERVAL 64
+
+/**
+ * Number of pivots after which the basis inverse is rebuilt from scratch,
+ * bounding the length of the eta file that every pivot appends to.
+ */
+#define SIMPLEX_REFACTOR_INTERVAL 100
+
+/**
+ * Simplex status codes.
+ */
+typedef enum simplex_status {
+    SIMPLEX_OPTIMAL,        /* An optimal solution was found */
+    SIMPLEX_INFEASIBLE,     /* The constraints cannot be satisfied */
+    SIMPLEX_UNBOUNDED,      /* The objective is unbounded below */
+    SIMPLEX_ITERATION_LIMIT, /* The solver gave up before reaching optimality */
+    SIMPLEX_NUMERICAL_ERROR  /* The basis became numerically singular */
+} simplex_status_t;
+
+/**
+ * A linear program: minimize `cost . x` subject to `A x = rhs` and
+ * `0 <= x <= upper`, where A has `rows` rows and `cols` columns. The nonzeros
+ * of row `i` of A are in columns `row_cols[row_start[i], row_start[i + 1])`,
+ * with coefficients `row_values` at the same positions (or 1 if `row_values` is
+ * NULL). Entries of `upper` may be `HUGE_VAL`.
+ */
+typedef struct simplex_problem {
+    int rows;
+    int cols;
+    const int* row_start;
+    const int* row_cols;
+    const double* row_values;
+    const double* rhs;
+    const double* cost;
+    const double* upper;
+} simplex_problem_t;
+
+/**
+ * Solve `problem`, storing an optimal vertex to `x` (which should have room for
+ * `problem->cols` values) on success.
+ *
+ * Phase 1 starts from a basis of artificial variables and minimizes their sum.
+ * Artificial variables left in the basis at zero, such as those of redundant
+ * constraints, are then fixed at zero for phase 2. Entering variables are
+ * chosen by Devex pricing and leaving variables by Harris' ratio test. The
+ * basis inverse is kept in product form, as a file of sparse eta vectors (one
+ * per pivot) that is rebuilt every `SIMPLEX_REFACTOR_INTERVAL` pivots, so its
+ * memory and the cost of every pivot grow with the nonzeros of the eta vectors
+ * rather than with rows^2.
+ */
+simplex_status_t simplex_solve(const simplex_problem_t* problem, double* x);
+
+#endif
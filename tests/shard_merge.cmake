@@ -0,0 +1,42 @@
+# Counts a board as SHARDS separate `sudoku-count --shard I/N` runs, feeds
+# their combined output to `sudoku-count --merge` on standard input and checks
+# that the merged count matches an unsharded count.
+#
+# Usage: cmake -DCOUNT=<sudoku-count> -DSHARDS=<N> -DWORK_DIR=<dir>
+#              -P shard_merge.cmake
+
+set(BOARD ${WORK_DIR}/shard_merge_${SHARDS}_board.txt)
+set(RESULTS ${WORK_DIR}/shard_merge_${SHARDS}_results.txt)
+
+# A 6x6 board with its first row filled in (39168 solutions).
+file(WRITE ${BOARD} "2 3\n1 2 3 4 5 6\n")
+foreach(row RANGE 1 5)
+    file(APPEND ${BOARD} "0 0 0 0 0 0\n")
+endforeach()
+
+execute_process(COMMAND ${COUNT} ${BOARD}
+                OUTPUT_VARIABLE expected RESULT_VARIABLE status)
+if(NOT status EQUAL 0)
+    message(FATAL_ERROR "Unsharded count failed: ${status}")
+endif()
+
+file(WRITE ${RESULTS} "")
+math(EXPR last "${SHARDS} - 1")
+foreach(index RANGE ${last})
+    execute_process(COMMAND ${COUNT} --shard ${index}/${SHARDS} ${BOARD}
+                    OUTPUT_VARIABLE result RESULT_VARIABLE status)
+    if(NOT status EQUAL 0)
+        message(FATAL_ERROR "Shard ${index}/${SHARDS} failed: ${status}")
+    endif()
+    file(APPEND ${RESULTS} "${result}")
+endforeach()
+
+execute_process(COMMAND ${COUNT} --merge INPUT_FILE ${RESULTS}
+                OUTPUT_VARIABLE merged RESULT_VARIABLE status)
+if(NOT status EQUAL 0)
+    message(FATAL_ERROR "Merge failed: ${status}")
+endif()
+
+if(NOT merged STREQUAL expected)
+    message(FATAL_ERROR "Merged count ${merged} does not match ${expected}")
+endif()
@@ -4,38 +4,74 @@
 #include <assert.h>
 #include <stdio.h>
 
-#define VAL(row, col) board_access(&board, row, col)->value
+#define SET(row, col, val) board_set_value(&board, row, col, val)
+
+static void check_exact_estimate(board_t* board) {
+    solution_estimate_t estimate;
+
+    num_solutions_estimate(board, 100, &estimate);
+    assert(estimate.exact);
+    assert(estimate.count == num_solutions(board));
+    assert(estimate.low == estimate.count && estimate.high == estimate.count);
+}
+
+static void test_estimate_large(void) {
+    board_t board;
+    solution_estimate_t estimate;
+
+    board_init(&board, 3, 3);
+    num_solutions_estimate(&board, 2000, &estimate);
+    assert(!estimate.exact);
+    assert(estimate.probes == 2000);
+    assert(estimate.low <= estimate.count && estimate.count <= estimate.high);
+
+    /* There are about 6.67e21 9x9 grids - check the order of magnitude. */
+    assert(estimate.count > 6.67e20 && estimate.count < 6.67e22);
+    board_destroy(&board);
+}
 
 int main() {
     board_t board;
     board_init(&board, 2, 2);
+    check_exact_estimate(&board);
     assert(num_solutions(&board) == 288); /* According to wikipedia */
+    assert(num_solutions_limit(&board, 2) == 2);
+    assert(num_solutions_limit(&board, 288) == 288);
+    assert(num_solutions_limit(&board, 1000) == 288);
+    assert(num_solutions_limit(&board, 0) == 288);
 
-    VAL(0, 0) = 1;
-    VAL(0, 1) = 1;
+    SET(0, 0, 1);
+    SET(0, 1, 1);
     assert(num_solutions(&board) == 0);
 
-    VAL(0, 1) = 2;
-    VAL(0, 2) = 3;
-    VAL(0, 3) = 4;
-    VAL(1, 0) = 3;
-    VAL(1, 1) = 4;
-    VAL(1, 2) = 1;
-    VAL(1, 3) = 2;
-    VAL(2, 1) = 1;
+    SET(0, 1, 2);
+    SET(0, 2, 3);
+    SET(0, 3, 4);
+    SET(1, 0, 3);
+    SET(1, 1, 4);
+    SET(1, 2, 1);
+    SET(1, 3, 2);
+    SET(2, 1, 1);
     assert(num_solutions(&board) == 2);
+    assert(num_solutions_limit(&board, 1) == 1);
+    check_exact_estimate(&board);
 
-    VAL(2, 0) = 2;
-    VAL(2, 2) = 4;
-    VAL(2, 3) = 3;
-    VAL(3, 0) = 4;
-    VAL(3, 1) = 3;
-    VAL(3, 2) = 2;
-    VAL(3, 3) = 1;
+    SET(2, 0, 2);
+    SET(2, 2, 4);
+    SET(2, 3, 3);
+    SET(3, 0, 4);
+    SET(3, 1, 3);
+    SET(3, 2, 2);
+    SET(3, 3, 1);
     assert(num_solutions(&board) == 1);
+    assert(num_solutions_limit(&board, 2) == 1);
 
-    VAL(3, 3) = 3;
+    SET(3, 3, 3);
     assert(num_solutions(&board) == 0);
+    check_exact_estimate(&board);
+
+    board_destroy(&board);
+    test_estimate_large();
 
     return 0;
 }
@@ -0,0 +1,67 @@
+#include "bandcount.h"
+
+#include "backtrack.h"
+#include "bignum.h"
+#include "board.h"
+#include <assert.h>
+
+static unsigned long count_bands(const board_t* board) {
+    bignum_t count;
+    unsigned long value;
+
+    bignum_init(&count, 0);
+    assert(band_count(board, &count));
+    assert(bignum_to_ulong(&count, &value));
+    bignum_destroy(&count);
+
+    return value;
+}
+
+static void test_bandcount_empty(void) {
+    board_t board;
+
+    board_init(&board, 2, 2);
+    assert(count_bands(&board) == 288);
+    board_destroy(&board);
+
+    board_init(&board, 2, 3);
+    assert(count_bands(&board) == 28200960UL);
+    board_destroy(&board);
+
+    board_init(&board, 3, 2);
+    assert(count_bands(&board) == 28200960UL);
+    board_destroy(&board);
+}
+
+static void test_bandcount_givens(void) {
+    board_t board;
+    int col;
+
+    board_init(&board, 2, 3);
+    for (col = 0; col < 6; col++) {
+        board_set_value(&board, 0, col, col + 1);
+    }
+    assert(count_bands(&board) == (unsigned long)num_solutions(&board));
+
+    /* Fixed values in later bands disable canonical column sets. */
+    board_set_value(&board, 4, 0, 2);
+    board_set_value(&board, 5, 5, 3);
+    assert(count_bands(&board) == (unsigned long)num_solutions(&board));
+
+    /* Fixed values that conflict with each other. */
+    board_set_value(&board, 5, 4, 3);
+    assert(count_bands(&board) == 0);
+    board_destroy(&board);
+
+    board_init(&board, 2, 2);
+    board_set_value(&board, 3, 3, 4);
+    board_set_value(&board, 2, 0, 4);
+    assert(count_bands(&board) == (unsigned long)num_solutions(&board));
+    board_destroy(&board);
+}
+
+int main() {
+    test_bandcount_empty();
+    test_bandcount_givens();
+    return 0;
+}
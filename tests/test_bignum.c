@@ -0,0 +1,73 @@
+#include "bignum.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_PATH "test_bignum.txt"
+
+static void check_printed(const bignum_t* num, const char* expected) {
+    char buf[128];
+    FILE* stream = fopen(TEST_PATH, "w+");
+
+    assert(stream);
+    bignum_print(num, stream);
+    rewind(stream);
+    assert(fgets(buf, sizeof(buf), stream));
+    fclose(stream);
+    remove(TEST_PATH);
+
+    assert(!strcmp(buf, expected));
+}
+
+static void test_bignum_small(void) {
+    bignum_t num;
+    bignum_t other;
+    unsigned long value;
+
+    bignum_init(&num, 0);
+    assert(bignum_is_zero(&num));
+    check_printed(&num, "0");
+
+    bignum_init(&other, 99990001UL);
+    bignum_add(&num, &other);
+    bignum_add(&num, &other);
+    assert(bignum_to_ulong(&num, &value) && value == 199980002UL);
+    check_printed(&num, "199980002");
+
+    bignum_mul_small(&num, 0);
+    assert(bignum_is_zero(&num));
+
+    bignum_destroy(&other);
+    bignum_destroy(&num);
+}
+
+static void test_bignum_factorial(void) {
+    bignum_t num;
+    bignum_t copy;
+    unsigned long value;
+    unsigned long i;
+
+    bignum_init(&num, 1);
+    for (i = 2; i <= 30; i++) {
+        bignum_mul_small(&num, i);
+    }
+
+    /* 30! does not fit in 64 bits. */
+    assert(!bignum_to_ulong(&num, &value));
+    check_printed(&num, "265252859812191058636308480000000");
+
+    bignum_init(&copy, 7);
+    bignum_assign(&copy, &num);
+    bignum_add(&copy, &num);
+    check_printed(&copy, "530505719624382117272616960000000");
+
+    bignum_destroy(&copy);
+    bignum_destroy(&num);
+}
+
+int main() {
+    test_bignum_small();
+    test_bignum_factorial();
+    return 0;
+}
@@ -1,5 +1,6 @@
 #include "board.h"
 
+#include "bitset.h"
 #include "bool.h"
 #include <assert.h>
 #include <stddef.h>
@@ -20,9 +21,46 @@ static void test_board_access(void) {
     board_init(&board, 2, 5);
     assert(board_block_size(&board) == 10);
 
-    assert(board.cells[13].value == 0);
-    board_access(&board, 1, 3)->value = 17;
-    assert(board.cells[13].value == 17);
+    assert(board_get_value_at(&board, 13) == 0);
+    board_set_value(&board, 1, 3, 7);
+    assert(board_get_value_at(&board, 13) == 7);
+
+    assert(board_get_flags(&board, 1, 3) == CF_NONE);
+    board_set_flags(&board, 1, 3, CF_FIXED);
+    assert(board_get_flags_at(&board, 13) == CF_FIXED);
+    assert(BITSET_TEST(board.fixed, 13) && !BITSET_TEST(board.errors, 13));
+    board_set_flags_at(&board, 13, CF_ERROR);
+    assert(board_get_flags(&board, 1, 3) == CF_ERROR);
+    assert(!BITSET_TEST(board.fixed, 13) && BITSET_TEST(board.errors, 13));
+    board_set_flags(&board, 1, 3, CF_NONE);
+    assert(board_get_flags(&board, 1, 3) == CF_NONE);
+
+    board_destroy(&board);
+}
+
+static void test_board_packed_values(void) {
+    board_t board;
+    board_t copy;
+
+    board_init(&board, 3, 3);
+    assert(board.values8 && !board.values16);
+
+    board_set_value(&board, 4, 7, 9);
+    assert(board_get_value_at(&board, 4 * 9 + 7) == 9);
+    assert(board_get_value(&board, 4, 7) == 9);
+
+    board_clone(&copy, &board);
+    assert(board_get_value_at(&copy, 4 * 9 + 7) == 9);
+    board_destroy(&copy);
+    board_destroy(&board);
+
+    /* Block sizes above 255 need wider storage */
+    board_init(&board, 16, 16);
+    assert(!board.values8 && board.values16);
+
+    board_set_value(&board, 255, 3, 256);
+    assert(board_get_value_at(&board, 255 * 256 + 3) == 256);
+    board_destroy(&board);
 }
 
 static void check_contents(FILE* stream, const char* expected) {
@@ -37,7 +75,6 @@ static void check_contents(FILE* stream, const char* expected) {
 
 static void test_board_print(void) {
     board_t board;
-    cell_t* cell;
 
     FILE* stream;
     const char* expected_marked =
@@ -76,20 +113,14 @@ static void test_board_print(void) {
         "-------------------------------------------\n";
 
     board_init(&board, 2, 5);
-    cell = board_access(&board, 0, 3);
-    cell->value = 5;
-    cell->flags = CF_FIXED;
-    cell = board_access(&board, 1, 4);
-    cell->value = 5;
-    cell->flags = CF_ERROR;
-    cell = board_access(&board, 2, 6);
-    cell->value = 6;
-    cell = board_access(&board, 3, 5);
-    cell->value = 7;
-    cell = board_access(&board, 3, 6);
-    cell->value = 8;
-    cell = board_access(&board, 7, 2);
-    cell->value = 3;
+    board_set_value(&board, 0, 3, 5);
+    board_set_flags(&board, 0, 3, CF_FIXED);
+    board_set_value(&board, 1, 4, 5);
+    board_set_flags(&board, 1, 4, CF_ERROR);
+    board_set_value(&board, 2, 6, 6);
+    board_set_value(&board, 3, 5, 7);
+    board_set_value(&board, 3, 6, 8);
+    board_set_value(&board, 7, 2, 3);
 
     stream = tmpfile();
     board_print(&board, stream, TRUE);
@@ -118,12 +149,12 @@ static void test_board_serialize(void) {
 
     for (row = 0; row < 6; row++) {
         for (col = 0; col < 6; col++) {
-            board_access(&board, row, col)->value = (row + col) % 6 + 1;
+            board_set_value(&board, row, col, (row + col) % 6 + 1);
         }
     }
 
-    board_access(&board, 2, 4)->flags = CF_FIXED;
-    board_access(&board, 3, 3)->flags = CF_FIXED;
+    board_set_flags(&board, 2, 4, CF_FIXED);
+    board_set_flags(&board, 3, 3, CF_FIXED);
 
     stream = tmpfile();
 
@@ -163,14 +194,14 @@ static void test_board_deserialize(void) {
 
     for (row = 0; row < 6; row++) {
         for (col = 0; col < 6; col++) {
-            const cell_t* cell = board_access_const(&board, row, col);
+            cell_flags_t flags = board_get_flags(&board, row, col);
 
-            assert(cell->value == (row + col) % 6 + 1);
+            assert(board_get_value(&board, row, col) == (row + col) % 6 + 1);
 
             if ((row == 2 && col == 4) || (row == 3 && col == 3)) {
-                assert(cell_is_fixed(cell));
+                assert(flags == CF_FIXED);
             } else {
-                assert(cell->flags == CF_NONE);
+                assert(flags == CF_NONE);
             }
         }
     }
@@ -344,11 +375,11 @@ static void test_board_check_legal(void) {
 
     for (row = 0; row < 9; row++) {
         for (col = 0; col < 9; col++) {
-            assert(!cell_is_error(board_access(&board, row, col)));
+            assert(board_get_flags(&board, row, col) != CF_ERROR);
         }
     }
 
-    board_access(&board, 0, 2)->value = 6;
+    board_set_value(&board, 0, 2, 6);
     assert(!board_is_legal(&board));
 
     board_mark_errors(&board);
@@ -356,7 +387,7 @@ static void test_board_check_legal(void) {
     board_print(&board, stream, TRUE);
     check_contents(stream, expected1);
 
-    board_access(&board, 8, 8)->value = 5;
+    board_set_value(&board, 8, 8, 5);
     assert(!board_is_legal(&board));
 
     board_mark_errors(&board);
@@ -364,8 +395,8 @@ static void test_board_check_legal(void) {
     board_print(&board, stream, TRUE);
     check_contents(stream, expected2);
 
-    board_access(&board, 8, 8)->value = 7;
-    board_access(&board, 0, 2)->value = 7;
+    board_set_value(&board, 8, 8, 7);
+    board_set_value(&board, 0, 2, 7);
     assert(board_is_legal(&board));
 
     board_mark_errors(&board);
@@ -374,14 +405,297 @@ static void test_board_check_legal(void) {
     check_contents(stream, expected3);
 }
 
+static void test_board_legal_placement(void) {
+    board_t board;
+    int candidates[4];
+
+    board_init(&board, 2, 2);
+
+    board_set_value(&board, 0, 0, 1);
+    board_set_value(&board, 1, 3, 2);
+    board_set_value(&board, 3, 1, 3);
+
+    assert(board_block_index(&board, 1, 3) == 1);
+    assert(board_block_index(&board, 3, 1) == 2);
+
+    /* Row, column and block conflicts */
+    assert(!board_is_legal_placement(&board, 0, 3, 1));
+    assert(!board_is_legal_placement(&board, 2, 0, 1));
+    assert(!board_is_legal_placement(&board, 1, 1, 1));
+    assert(!board_is_legal_placement(&board, 0, 2, 2));
+    assert(board_is_legal_placement(&board, 0, 1, 2));
+
+    /* The cell's own value never conflicts with itself */
+    assert(board_is_legal_placement(&board, 0, 0, 1));
+
+    assert(board_gather_candidates(&board, 0, 1, candidates) == 2);
+    assert(candidates[0] == 2 && candidates[1] == 4);
+
+    /* Removing a value releases it for its neighbors */
+    board_set_value(&board, 0, 0, 0);
+    assert(board_is_legal_placement(&board, 0, 3, 1));
+    assert(board_gather_candidates(&board, 0, 1, candidates) == 3);
+
+    /* Any existing conflict leaves no legal candidates */
+    board_set_value(&board, 2, 2, 3);
+    board_set_value(&board, 2, 3, 3);
+    assert(board_gather_candidates(&board, 0, 1, candidates) == 0);
+
+    board_destroy(&board);
+}
+
+static void test_board_compute_all_candidates(void) {
+    board_t board;
+    board_candidates_t candidates;
+    int row, col;
+
+    board_init(&board, 2, 3);
+
+    board_set_value(&board, 0, 0, 1);
+    board_set_value(&board, 0, 4, 6);
+    board_set_value(&board, 3, 1, 2);
+    board_set_value(&board, 5, 5, 3);
+
+    board_compute_all_candidates(&board, &candidates);
+
+    for (row = 0; row < 6; row++) {
+        for (col = 0; col < 6; col++) {
+            const bitset_word_t* set =
+                board_candidates_access(&candidates, row, col);
+            int candidate_list[6];
+            int count, i;
+
+            if (board_get_value(&board, row, col)) {
+                assert(bitset_count(set, candidates.words) == 0);
+                continue;
+            }
+
+            /* The matrix should agree with per-cell gathering. */
+            count = board_gather_candidates(&board, row, col, candidate_list);
+            assert(bitset_count(set, candidates.words) == count);
+            for (i = 0; i < count; i++) {
+                assert(BITSET_TEST(set, candidate_list[i] - 1));
+            }
+        }
+    }
+
+    board_candidates_destroy(&candidates);
+
+    board_set_value(&board, 1, 1, 1);
+    board_compute_all_candidates(&board, &candidates);
+    assert(bitset_count(board_candidates_access(&candidates, 2, 2),
+                        candidates.words) == 0);
+    board_candidates_destroy(&candidates);
+
+    board_destroy(&board);
+}
+
+static void test_board_incremental_errors(void) {
+    board_t board;
+    board_t marked;
+    int row, col;
+
+    board_init(&board, 2, 3);
+
+    board_set_value(&board, 0, 0, 4);
+    board_set_flags(&board, 0, 0, CF_FIXED);
+
+    board_set_value(&board, 0, 5, 4); /* row conflict with a fixed cell */
+    board_set_value(&board, 1, 1, 4); /* block conflict with a fixed cell */
+    board_set_value(&board, 5, 5, 4); /* column conflict with (0, 5) */
+    board_set_value(&board, 3, 3, 2);
+
+    assert(board_get_flags(&board, 0, 0) == CF_FIXED);
+    assert(board_get_flags(&board, 0, 5) == CF_ERROR);
+    assert(board_get_flags(&board, 1, 1) == CF_ERROR);
+    assert(board_get_flags(&board, 5, 5) == CF_ERROR);
+    assert(board_get_flags(&board, 3, 3) != CF_ERROR);
+
+    /* Incremental marking should agree with a full recheck. */
+    board_clone(&marked, &board);
+    board_mark_errors(&marked);
+    for (row = 0; row < 6; row++) {
+        for (col = 0; col < 6; col++) {
+            assert(board_get_flags(&board, row, col) ==
+                   board_get_flags(&marked, row, col));
+        }
+    }
+    board_destroy(&marked);
+
+    /* Resolving conflicts clears the flags of every cell involved. */
+    board_set_value(&board, 0, 5, 1);
+    assert(board_get_flags(&board, 0, 5) != CF_ERROR);
+    assert(board_get_flags(&board, 5, 5) != CF_ERROR);
+    assert(board_get_flags(&board, 1, 1) == CF_ERROR);
+
+    board_set_value(&board, 1, 1, 0);
+    assert(board_get_flags(&board, 1, 1) != CF_ERROR);
+
+    board_set_value(&board, 4, 3, 2);
+    assert(board_get_flags(&board, 3, 3) == CF_ERROR);
+    assert(board_get_flags(&board, 4, 3) == CF_ERROR);
+    board_set_value(&board, 4, 3, 3);
+    assert(board_get_flags(&board, 3, 3) != CF_ERROR);
+    assert(board_get_flags(&board, 4, 3) != CF_ERROR);
+
+    board_destroy(&board);
+}
+
+static void test_board_solved_state(void) {
+    const int solution[4][4] = {
+        {1, 2, 3, 4}, {3, 4, 1, 2}, {2, 1, 4, 3}, {4, 3, 2, 1}};
+
+    board_t board;
+    board_t copy;
+    int row, col;
+
+    board_init(&board, 2, 2);
+    assert(board.empty_count == 16);
+    assert(!board_is_full(&board));
+    assert(!board_has_conflicts(&board));
+    assert(!board_is_solved(&board));
+
+    for (row = 0; row < 4; row++) {
+        for (col = 0; col < 4; col++) {
+            board_set_value(&board, row, col, solution[row][col]);
+        }
+    }
+
+    assert(board.empty_count == 0);
+    assert(board_is_solved(&board));
+
+    /* (0, 0) now conflicts with its row, column and block neighbors */
+    board_set_value(&board, 0, 0, 4);
+    assert(board.conflict_count == 3);
+    assert(board_is_full(&board));
+    assert(board_has_conflicts(&board));
+    assert(!board_is_solved(&board));
+    assert(!board_is_legal(&board));
+
+    board_clone(&copy, &board);
+    assert(copy.conflict_count == 3 && copy.empty_count == 0);
+    board_destroy(&copy);
+
+    board_set_value(&board, 0, 0, 0);
+    assert(board.empty_count == 1);
+    assert(!board_has_conflicts(&board));
+    assert(board_is_legal(&board));
+
+    board_set_value(&board, 0, 0, 1);
+    assert(board_is_solved(&board));
+
+    board_destroy(&board);
+}
+
+static void test_board_block_major_layout(void) {
+    board_t row_major;
+    board_t block_major;
+    board_t copy;
+    board_candidates_t row_candidates;
+    board_candidates_t block_candidates;
+    int row, col, i;
+
+    board_init(&row_major, 2, 3);
+    board_init_layout(&block_major, 2, 3, BL_BLOCK_MAJOR);
+    assert(board_get_layout(&block_major) == BL_BLOCK_MAJOR);
+
+    board_set_value(&block_major, 2, 4, 5);
+    assert(board_get_value_at(&block_major, 3 * 6 + 1) == 5);
+    assert(board_get_value(&block_major, 2, 4) == 5);
+
+    board_set_value(&row_major, 2, 4, 5);
+    board_set_value(&row_major, 0, 1, 3);
+    board_set_value(&block_major, 0, 1, 3);
+    board_set_value(&row_major, 5, 0, 3);
+    board_set_value(&block_major, 5, 0, 3);
+
+    assert(board_is_legal(&block_major));
+    board_compute_all_candidates(&row_major, &row_candidates);
+    board_compute_all_candidates(&block_major, &block_candidates);
+
+    for (row = 0; row < 6; row++) {
+        for (col = 0; col < 6; col++) {
+            const bitset_word_t* a =
+                board_candidates_access(&row_candidates, row, col);
+            const bitset_word_t* b =
+                board_candidates_access(&block_candidates, row, col);
+
+            for (i = 0; i < row_candidates.words; i++) {
+                assert(a[i] == b[i]);
+            }
+        }
+    }
+
+    board_candidates_destroy(&block_candidates);
+    board_candidates_destroy(&row_candidates);
+
+    /* Conflicts are tracked in the same way. */
+    board_set_value(&block_major, 4, 1, 3);
+    assert(board_get_flags(&block_major, 5, 0) == CF_ERROR);
+    assert(!board_is_legal(&block_major));
+
+    board_clone(&copy, &block_major);
+    assert(board_get_layout(&copy) == BL_BLOCK_MAJOR);
+    assert(board_get_value(&copy, 2, 4) == 5);
+    assert(board_has_conflicts(&copy));
+
+    board_destroy(&copy);
+    board_destroy(&block_major);
+    board_destroy(&row_major);
+}
+
+static void test_board_hash(void) {
+    board_t board;
+    board_t other;
+    board_t copy;
+    board_hash_t hash;
+
+    board_init(&board, 2, 2);
+    board_init(&other, 2, 2);
+    assert(board_hash(&board) == 0);
+
+    board_set_value(&board, 0, 0, 1);
+    board_set_value(&board, 1, 2, 3);
+    hash = board_hash(&board);
+    assert(hash != 0);
+
+    /* The hash only depends on the values, not on the order of changes. */
+    board_set_value(&other, 1, 2, 4);
+    board_set_value(&other, 0, 0, 1);
+    board_set_value(&other, 1, 2, 3);
+    assert(board_hash(&other) == hash);
+
+    board_set_value(&other, 1, 2, 0);
+    assert(board_hash(&other) != hash);
+    board_set_value(&other, 0, 0, 0);
+    assert(board_hash(&other) == 0);
+
+    board_clone(&copy, &board);
+    assert(board_hash(&copy) == hash);
+
+    assert(board_zobrist_key(0, 1) != board_zobrist_key(0, 2));
+    assert(board_zobrist_key(0, 1) != board_zobrist_key(1, 1));
+
+    board_destroy(&copy);
+    board_destroy(&other);
+    board_destroy(&board);
+}
+
 int main() {
     test_board_block_pos();
     test_board_access();
+    test_board_packed_values();
     test_board_print();
     test_board_serialize();
     test_board_deserialize();
     test_board_deserialize_err_fmt();
     test_board_deserialize_err_cell_val();
     test_board_check_legal();
+    test_board_legal_placement();
+    test_board_compute_all_candidates();
+    test_board_incremental_errors();
+    test_board_solved_state();
+    test_board_block_major_layout();
+    test_board_hash();
     return 0;
 }
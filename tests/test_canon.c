@@ -0,0 +1,234 @@
+#include "canon.h"
+
+#include "board.h"
+#include <assert.h>
+#include <stdlib.h>
+
+/**
+ * Initialize `board` with a solution in which every row is a shifted copy of
+ * the first.
+ */
+static void init_solution(board_t* board, int m, int n) {
+    int block_size = m * n;
+    int row;
+    int col;
+
+    board_init(board, m, n);
+    for (row = 0; row < block_size; row++) {
+        for (col = 0; col < block_size; col++) {
+            board_set_value(board, row, col,
+                            (n * (row % m) + row / m + col) % block_size + 1);
+        }
+    }
+}
+
+static void shuffle(int* items, int count) {
+    int i;
+
+    for (i = count - 1; i > 0; i--) {
+        int j = rand() % (i + 1);
+        int tmp = items[i];
+        items[i] = items[j];
+        items[j] = tmp;
+    }
+}
+
+/**
+ * Fill `lines` with a random order of `groups` groups of `size` lines each,
+ * keeping the lines of every group together.
+ */
+static void random_lines(int* lines, int groups, int size) {
+    int order[CANON_MAX_BLOCK_SIZE];
+    int local[CANON_MAX_BLOCK_SIZE];
+    int group;
+    int i;
+
+    for (group = 0; group < groups; group++) {
+        order[group] = group;
+    }
+    shuffle(order, groups);
+
+    for (group = 0; group < groups; group++) {
+        for (i = 0; i < size; i++) {
+            local[i] = i;
+        }
+        shuffle(local, size);
+        for (i = 0; i < size; i++) {
+            lines[group * size + i] = order[group] * size + local[i];
+        }
+    }
+}
+
+static void random_transform(const board_t* board,
+                             canon_transform_t* transform) {
+    int block_size = board_block_size(board);
+    int value;
+
+    transform->transposed = board->m == board->n && rand() % 2;
+    random_lines(transform->rows, board->n, board->m);
+    random_lines(transform->cols, board->m, board->n);
+
+    for (value = 0; value <= block_size; value++) {
+        transform->values[value] = value;
+    }
+    shuffle(&transform->values[1], block_size);
+}
+
+static bool_t boards_equal(const board_t* a, const board_t* b) {
+    int block_size = board_block_size(a);
+    int row;
+    int col;
+
+    for (row = 0; row < block_size; row++) {
+        for (col = 0; col < block_size; col++) {
+            if (board_get_value(a, row, col) !=
+                board_get_value(b, row, col)) {
+                return FALSE;
+            }
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * Check that random images of `board` share its canonical board and hash, and
+ * that the reported transforms map each board to it.
+ */
+static void check_invariance(const board_t* board, int rounds) {
+    board_t canonical;
+    board_t image;
+    board_t image_canonical;
+    board_t mapped;
+    canon_transform_t transform;
+    canon_hash_t hash;
+    canon_hash_t image_hash;
+    int round;
+
+    assert(canon_board(board, &canonical, &transform, &hash));
+    canon_apply(board, &transform, &mapped);
+    assert(boards_equal(&mapped, &canonical));
+    board_destroy(&mapped);
+
+    for (round = 0; round < rounds; round++) {
+        random_transform(board, &transform);
+        canon_apply(board, &transform, &image);
+
+        assert(canon_board(&image, &image_canonical, &transform, &image_hash));
+        assert(boards_equal(&image_canonical, &canonical));
+        assert(canon_hash_equal(&image_hash, &hash));
+
+        canon_apply(&image, &transform, &mapped);
+        assert(boards_equal(&mapped, &canonical));
+
+        board_destroy(&mapped);
+        board_destroy(&image_canonical);
+        board_destroy(&image);
+    }
+
+    board_destroy(&canonical);
+}
+
+static void test_canon_solutions(void) {
+    board_t board;
+
+    init_solution(&board, 2, 2);
+    assert(board_is_solved(&board));
+    check_invariance(&board, 20);
+    board_destroy(&board);
+
+    init_solution(&board, 2, 3);
+    assert(board_is_solved(&board));
+    check_invariance(&board, 10);
+    board_destroy(&board);
+
+    init_solution(&board, 3, 3);
+    assert(board_is_solved(&board));
+    check_invariance(&board, 5);
+    board_destroy(&board);
+}
+
+static void test_canon_puzzles(void) {
+    board_t board;
+    int block_size;
+    int row;
+    int col;
+
+    init_solution(&board, 3, 3);
+    block_size = board_block_size(&board);
+    for (row = 0; row < block_size; row++) {
+        for (col = 0; col < block_size; col++) {
+            if (rand() % 3) {
+                board_set_value(&board, row, col, 0);
+            }
+        }
+    }
+    check_invariance(&board, 5);
+    board_destroy(&board);
+
+    init_solution(&board, 3, 2);
+    board_set_value(&board, 0, 0, 0);
+    board_set_value(&board, 3, 4, 0);
+    check_invariance(&board, 10);
+    board_destroy(&board);
+
+    board_init(&board, 2, 3);
+    check_invariance(&board, 5);
+    board_destroy(&board);
+}
+
+static void test_canon_distinct(void) {
+    board_t same_band;
+    board_t other_band;
+    canon_hash_t same_hash;
+    canon_hash_t other_hash;
+    board_t canonical;
+
+    /* Two givens in one band cannot be moved into different bands. */
+    board_init(&same_band, 2, 2);
+    board_set_value(&same_band, 0, 0, 1);
+    board_set_value(&same_band, 1, 2, 2);
+
+    board_init(&other_band, 2, 2);
+    board_set_value(&other_band, 0, 0, 1);
+    board_set_value(&other_band, 2, 2, 2);
+
+    assert(canon_board(&same_band, &canonical, NULL, &same_hash));
+    board_destroy(&canonical);
+    assert(canon_board(&other_band, &canonical, NULL, &other_hash));
+    board_destroy(&canonical);
+    assert(!canon_hash_equal(&same_hash, &other_hash));
+
+    /* Repeating a value is not the same as using a new one. */
+    board_set_value(&other_band, 2, 2, 1);
+    assert(canon_board(&other_band, &canonical, NULL, &other_hash));
+    board_destroy(&canonical);
+    assert(!canon_hash_equal(&same_hash, &other_hash));
+
+    board_destroy(&other_band);
+    board_destroy(&same_band);
+}
+
+static void test_canon_limits(void) {
+    board_t board;
+    board_t canonical;
+
+    /* Too many cells per block. */
+    board_init(&board, 4, 4);
+    assert(!canon_board(&board, &canonical, NULL, NULL));
+    board_destroy(&board);
+
+    /* Small enough blocks, but 6 * 120^3 column arrangements. */
+    board_init(&board, 3, 5);
+    assert(!canon_board(&board, &canonical, NULL, NULL));
+    board_destroy(&board);
+}
+
+int main() {
+    srand(18);
+    test_canon_solutions();
+    test_canon_puzzles();
+    test_canon_distinct();
+    test_canon_limits();
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include "checkpoint.h"
+
+#include "backtrack.h"
+#include "board.h"
+#include <assert.h>
+#include <stdio.h>
+
+#define TEST_PATH "test_checkpoint.chk"
+
+static void init_first_row(board_t* board, board_layout_t layout) {
+    int col;
+
+    board_init_layout(board, 2, 3, layout);
+    for (col = 0; col < 6; col++) {
+        board_set_value(board, 0, col, col + 1);
+    }
+}
+
+/**
+ * Count `board` in slices of `max_nodes` values, resuming from the checkpoint
+ * after every interruption.
+ */
+static void check_resumed(board_t* board, long max_nodes) {
+    checkpoint_opts_t opts;
+    checkpoint_status_t status;
+    long count = -1;
+    int resumes = 0;
+
+    opts.path = TEST_PATH;
+    opts.interval = max_nodes / 3 + 1;
+    opts.max_nodes = max_nodes;
+
+    status = checkpoint_count(board, &opts, &count);
+    while (status == CP_INTERRUPTED) {
+        resumes++;
+        status = checkpoint_resume(&opts, &count);
+    }
+
+    assert(status == CP_DONE);
+    assert(resumes > 0);
+    assert(count == num_solutions(board));
+
+    /* The checkpoint is removed once the count finishes. */
+    assert(!fopen(TEST_PATH, "r"));
+}
+
+static void test_checkpoint_first_row(void) {
+    board_t board;
+
+    init_first_row(&board, BL_ROW_MAJOR);
+    check_resumed(&board, 5000);
+    check_resumed(&board, 997);
+    board_destroy(&board);
+}
+
+static void test_checkpoint_block_major(void) {
+    board_t board;
+
+    init_first_row(&board, BL_BLOCK_MAJOR);
+    check_resumed(&board, 5000);
+    board_destroy(&board);
+}
+
+static void test_checkpoint_uninterrupted(void) {
+    board_t board;
+    checkpoint_opts_t opts;
+    long count = -1;
+
+    opts.path = TEST_PATH;
+    opts.interval = 0;
+    opts.max_nodes = 0;
+
+    board_init(&board, 2, 2);
+    assert(checkpoint_count(&board, &opts, &count) == CP_DONE);
+    assert(count == 288);
+    board_destroy(&board);
+}
+
+static void test_checkpoint_malformed(void) {
+    checkpoint_opts_t opts;
+    FILE* stream;
+    long count;
+
+    opts.path = TEST_PATH;
+    opts.interval = 0;
+    opts.max_nodes = 0;
+
+    remove(TEST_PATH);
+    assert(checkpoint_resume(&opts, &count) == CP_ERR_IO);
+
+    stream = fopen(TEST_PATH, "w");
+    assert(stream);
+    fputs("sudoku-checkpoint 2\nlayout 0 size 2 2\n"
+          "count 0 nodes 0 depth 1\n99 1 0\n",
+          stream);
+    fclose(stream);
+    assert(checkpoint_resume(&opts, &count) == CP_ERR_FMT);
+
+    /* Checkpoints written before counts were widened are rejected. */
+    stream = fopen(TEST_PATH, "w");
+    assert(stream);
+    fputs("sudoku-checkpoint 1\nlayout 0 size 2 2\n"
+          "count 0 nodes 0 depth 0\n",
+          stream);
+    fclose(stream);
+    assert(checkpoint_resume(&opts, &count) == CP_ERR_FMT);
+
+    stream = fopen(TEST_PATH, "w");
+    assert(stream);
+    fputs("not a checkpoint\n", stream);
+    fclose(stream);
+    assert(checkpoint_resume(&opts, &count) == CP_ERR_FMT);
+
+    remove(TEST_PATH);
+}
+
+int main() {
+    test_checkpoint_first_row();
+    test_checkpoint_block_major();
+    test_checkpoint_uninterrupted();
+    test_checkpoint_malformed();
+    return 0;
+}
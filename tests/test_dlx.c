@@ -0,0 +1,102 @@
+#include "dlx.h"
+
+#include "backtrack.h"
+#include "board.h"
+#include <assert.h>
+#include <stdio.h>
+
+static void load(board_t* board, const char* rows[]) {
+    int block_size = board_block_size(board);
+    int row, col;
+
+    for (row = 0; row < block_size; row++) {
+        for (col = 0; col < block_size; col++) {
+            char c = rows[row][col];
+            board_set_value(board, row, col, c == '.' ? 0 : c - '0');
+        }
+    }
+}
+
+/**
+ * Count the solutions of `board` with DLX, checking that the search engine
+ * agrees.
+ */
+static long count(board_t* board) {
+    dlx_t dlx;
+    long ret;
+
+    dlx_init(&dlx, board);
+    ret = dlx_count(&dlx);
+
+    /* The matrix should be restored after every run. */
+    assert(dlx_count(&dlx) == ret);
+    dlx_destroy(&dlx);
+
+    assert(num_solutions_engine(board, CE_DLX) == ret);
+    assert(num_solutions_engine(board, CE_SEARCH) == ret);
+    return ret;
+}
+
+static void test_dlx_count(void) {
+    board_t board;
+    int col;
+
+    board_init(&board, 2, 2);
+    assert(count(&board) == 288);
+
+    board_set_value(&board, 0, 0, 1);
+    board_set_value(&board, 0, 1, 1);
+    assert(count(&board) == 0);
+    board_destroy(&board);
+
+    board_init(&board, 2, 3);
+    for (col = 0; col < 6; col++) {
+        board_set_value(&board, 0, col, col + 1);
+    }
+    assert(count(&board) == 28200960 / 720);
+    board_destroy(&board);
+}
+
+static void test_dlx_solve(void) {
+    const char* rows[] = {"8........", "..36.....", ".7..9.2..",
+                          ".5...7...", "....457..", "...1...3.",
+                          "..1....68", "..85...1.", ".9....4.."};
+    board_t board;
+    board_t clues;
+    dlx_t dlx;
+    int row, col;
+
+    board_init(&board, 3, 3);
+    load(&board, rows);
+    board_clone(&clues, &board);
+
+    assert(count(&board) == 1);
+
+    dlx_init(&dlx, &board);
+    assert(dlx_solve(&dlx, &board));
+    dlx_destroy(&dlx);
+
+    assert(board_is_solved(&board));
+    for (row = 0; row < 9; row++) {
+        for (col = 0; col < 9; col++) {
+            int clue = board_get_value(&clues, row, col);
+            assert(!clue || board_get_value(&board, row, col) == clue);
+        }
+    }
+
+    /* Conflicting boards have no solution. */
+    board_set_value(&clues, 1, 0, 8);
+    dlx_init(&dlx, &clues);
+    assert(!dlx_solve(&dlx, &clues));
+    assert(board_get_value(&clues, 2, 0) == 0);
+    dlx_destroy(&dlx);
+
+    board_destroy(&clues);
+    board_destroy(&board);
+}
+
+int main() {
+    test_dlx_count();
+    test_dlx_solve();
+    return 0;
+}
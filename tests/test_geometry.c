@@ -0,0 +1,113 @@
+#include "geometry.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+static void test_geometry_cache(void) {
+    const geometry_t* a = geometry_acquire(2, 3, BL_ROW_MAJOR);
+    const geometry_t* b = geometry_acquire(2, 3, BL_ROW_MAJOR);
+    const geometry_t* c = geometry_acquire(3, 2, BL_ROW_MAJOR);
+
+    assert(a == b);
+    assert(a != c);
+    assert(a->refcount == 2);
+
+    geometry_release(b);
+    assert(a->refcount == 1);
+
+    geometry_release(c);
+    geometry_release(a);
+    geometry_release(NULL);
+}
+
+static void test_geometry_units(void) {
+    const geometry_t* geom = geometry_acquire(2, 3, BL_ROW_MAJOR);
+    const int* unit;
+    const int* units;
+
+    assert(geom->block_size == 6);
+    assert(geom->cell_count == 36);
+
+    /* Row 1 */
+    unit = geometry_unit(geom, UK_ROW * 6 + 1);
+    assert(unit[0] == 6 && unit[5] == 11);
+
+    /* Column 2 */
+    unit = geometry_unit(geom, UK_COL * 6 + 2);
+    assert(unit[0] == 2 && unit[1] == 8 && unit[5] == 32);
+
+    /* Block 3 spans rows 2-3 and columns 3-5 */
+    unit = geometry_unit(geom, UK_BLOCK * 6 + 3);
+    assert(unit[0] == 15 && unit[2] == 17 && unit[3] == 21 && unit[5] == 23);
+
+    /* Cell (4, 1) */
+    units = geometry_cell_units(geom, 4 * 6 + 1);
+    assert(units[UK_ROW] == UK_ROW * 6 + 4);
+    assert(units[UK_COL] == UK_COL * 6 + 1);
+    assert(units[UK_BLOCK] == UK_BLOCK * 6 + 4);
+
+    geometry_release(geom);
+}
+
+static void test_geometry_peers(void) {
+    const geometry_t* geom = geometry_acquire(3, 3, BL_ROW_MAJOR);
+    int idx;
+
+    assert(geom->peer_count == 20);
+    assert(geom->peers);
+
+    for (idx = 0; idx < geom->cell_count; idx++) {
+        const int* peers = &geom->peers[idx * geom->peer_count];
+        int i, j;
+
+        for (i = 0; i < geom->peer_count; i++) {
+            int row = idx / 9;
+            int col = idx % 9;
+            int peer_row = peers[i] / 9;
+            int peer_col = peers[i] % 9;
+
+            assert(peers[i] != idx);
+            assert(peer_row == row || peer_col == col ||
+                   (peer_row / 3 == row / 3 && peer_col / 3 == col / 3));
+
+            for (j = 0; j < i; j++) {
+                assert(peers[i] != peers[j]);
+            }
+        }
+    }
+
+    geometry_release(geom);
+}
+
+static void test_geometry_block_major(void) {
+    const geometry_t* geom = geometry_acquire(2, 3, BL_BLOCK_MAJOR);
+    const int* unit;
+    int block;
+
+    /* Cell (2, 4) is at local offset 1 of block 3 */
+    assert(geometry_cell_index(geom, 2, 4) == 3 * 6 + 1);
+
+    /* Blocks are contiguous */
+    for (block = 0; block < 6; block++) {
+        int local_off;
+
+        unit = geometry_unit(geom, UK_BLOCK * 6 + block);
+        for (local_off = 0; local_off < 6; local_off++) {
+            assert(unit[local_off] == block * 6 + local_off);
+        }
+    }
+
+    /* Row 1 passes through blocks 0, 1 and 2 */
+    unit = geometry_unit(geom, UK_ROW * 6 + 1);
+    assert(unit[0] == 3 && unit[2] == 5 && unit[3] == 9 && unit[5] == 11);
+
+    geometry_release(geom);
+}
+
+int main() {
+    test_geometry_cache();
+    test_geometry_units();
+    test_geometry_peers();
+    test_geometry_block_major();
+    return 0;
+}
@@ -34,8 +34,8 @@ static void test_delta_list_apply_revert(void) {
     delta_list_t delta;
 
     board_init(&board, 2, 2);
-    board_access(&board, 0, 0)->value = 3;
-    board_access(&board, 0, 2)->value = 5;
+    board_set_value(&board, 0, 0, 3);
+    board_set_value(&board, 0, 2, 5);
 
     delta_list_init(&delta);
     delta_list_add(&delta, 0, 0, 3, 7);
@@ -43,14 +43,14 @@ static void test_delta_list_apply_revert(void) {
     delta_list_add(&delta, 1, 3, 0, 2);
 
     delta_list_apply(&board, &delta, debug_printer_callback);
-    assert(board_access(&board, 0, 0)->value == 7);
-    assert(board_access(&board, 0, 2)->value == 2);
-    assert(board_access(&board, 1, 3)->value == 2);
+    assert(board_get_value(&board, 0, 0) == 7);
+    assert(board_get_value(&board, 0, 2) == 2);
+    assert(board_get_value(&board, 1, 3) == 2);
 
     delta_list_revert(&board, &delta, debug_printer_callback);
-    assert(board_access(&board, 0, 0)->value == 3);
-    assert(board_access(&board, 0, 2)->value == 5);
-    assert(board_access(&board, 1, 3)->value == 0);
+    assert(board_get_value(&board, 0, 0) == 3);
+    assert(board_get_value(&board, 0, 2) == 5);
+    assert(board_get_value(&board, 1, 3) == 0);
 
     delta_list_destroy(&delta);
 }
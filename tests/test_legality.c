@@ -0,0 +1,99 @@
+#include "legality.h"
+
+#include "bitset.h"
+#include "geometry.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void test_legality_kernel_detection(void) {
+    legality_kernel_t best = legality_best_kernel();
+
+    assert(legality_kernel_supported(LK_SCALAR));
+    assert(legality_kernel_supported(best));
+    assert(best == legality_best_kernel());
+}
+
+static void test_legality_find_duplicates(void) {
+    const geometry_t* geom = geometry_acquire(2, 3, BL_ROW_MAJOR);
+    bitset_word_t onehot[36] = {0};
+    bitset_word_t dups[UK_COUNT * 6];
+    int kernel;
+
+    for (kernel = 0; kernel < LK_COUNT; kernel++) {
+        memset(onehot, 0, sizeof(onehot));
+        onehot[0] = BITSET_WORD_MASK(2);
+        onehot[5] = BITSET_WORD_MASK(3);
+        onehot[35] = BITSET_WORD_MASK(2);
+        assert(!legality_find_duplicates(geom, onehot, dups,
+                                         (legality_kernel_t)kernel));
+
+        /* Row 0 and block 1 both contain 4 twice. */
+        onehot[4] = BITSET_WORD_MASK(3);
+        assert(legality_find_duplicates(geom, onehot, dups,
+                                        (legality_kernel_t)kernel));
+        assert(dups[UK_ROW * 6 + 0] == BITSET_WORD_MASK(3));
+        assert(dups[UK_BLOCK * 6 + 1] == BITSET_WORD_MASK(3));
+        assert(dups[UK_COL * 6 + 4] == 0);
+        assert(dups[UK_BLOCK * 6 + 0] == 0);
+    }
+
+    geometry_release(geom);
+}
+
+/**
+ * Check that every kernel agrees with the scalar one on random sparse boards
+ * of the specified geometry.
+ */
+static void check_kernels_agree(int m, int n, board_layout_t layout) {
+    const geometry_t* geom = geometry_acquire(m, n, layout);
+    int block_size = m * n;
+    int unit_count = UK_COUNT * block_size;
+
+    bitset_word_t* onehot =
+        calloc(block_size * block_size, sizeof(bitset_word_t));
+    bitset_word_t* expected = calloc(unit_count, sizeof(bitset_word_t));
+    bitset_word_t* actual = calloc(unit_count, sizeof(bitset_word_t));
+
+    int trial, idx, kernel;
+
+    for (trial = 0; trial < 20; trial++) {
+        bool_t expected_ret;
+
+        for (idx = 0; idx < block_size * block_size; idx++) {
+            int value = rand() % block_size;
+            onehot[idx] = rand() % 4 ? 0 : BITSET_WORD_MASK(value);
+        }
+
+        expected_ret =
+            legality_find_duplicates(geom, onehot, expected, LK_SCALAR);
+
+        for (kernel = 0; kernel < LK_COUNT; kernel++) {
+            assert(legality_find_duplicates(geom, onehot, actual,
+                                            (legality_kernel_t)kernel) ==
+                   expected_ret);
+            assert(!memcmp(expected, actual,
+                           unit_count * sizeof(bitset_word_t)));
+        }
+    }
+
+    free(actual);
+    free(expected);
+    free(onehot);
+    geometry_release(geom);
+}
+
+static void test_legality_kernels_agree(void) {
+    srand(7);
+    check_kernels_agree(3, 3, BL_ROW_MAJOR);
+    check_kernels_agree(3, 5, BL_ROW_MAJOR);
+    check_kernels_agree(3, 5, BL_BLOCK_MAJOR);
+    check_kernels_agree(8, 8, BL_ROW_MAJOR);
+}
+
+int main() {
+    test_legality_kernel_detection();
+    test_legality_find_duplicates();
+    test_legality_kernels_agree();
+    return 0;
+}
@@ -2,13 +2,15 @@
 
 #include "board.h"
 #include <assert.h>
+#include <math.h>
 #include <stdio.h>
+#include <string.h>
 
-#define VAL(row, col) board_access(&board, row, col)->value
+#define SET(row, col, val) board_set_value(&board, row, col, val)
 
-int main() {
+static void test_lp_env(lp_env_t env) {
     board_t board;
-    lp_env_t env;
+    lp_stats_t stats;
     int block_size;
     int i, j;
 
@@ -17,10 +19,8 @@ int main() {
     board_init(&board, 3, 3);
     block_size = board_block_size(&board);
 
-    VAL(0, 0) = 1;
-    VAL(5, 7) = 3;
-
-    assert(lp_env_create(&env));
+    SET(0, 0, 1);
+    SET(5, 7, 3);
 
     assert(lp_solve_continuous(env, &board, candidate_board) == LP_SUCCESS);
     for (i = 0; i < block_size; i++) {
@@ -28,38 +28,51 @@ int main() {
             int k;
             lp_cell_candidates_t* candidates =
                 &candidate_board[i * block_size + j];
+            double total = 0.0;
 
             for (k = 0; k < candidates->size; k++) {
                 fprintf(stderr, "(%d, %d): %d (%f)\n", i, j,
                         candidates->candidates[k].val,
                         candidates->candidates[k].score);
+                total += candidates->candidates[k].score;
+            }
+
+            /* Every empty cell holds exactly one value in total. */
+            if (!board_get_value(&board, i, j)) {
+                assert(fabs(total - 1.0) < 1e-6);
             }
+            lp_cell_candidates_destroy(candidates);
         }
     }
 
+    lp_env_reset_stats(env);
     assert(lp_validate_ilp(env, &board) == LP_SUCCESS);
     assert(lp_solve_ilp(env, &board) == LP_SUCCESS);
 
+    lp_env_stats(env, &stats);
+    assert(stats.solves == 2);
+    assert(stats.build_time >= 0.0 && stats.solve_time >= 0.0);
+
     board_print(&board, stderr, FALSE);
     assert(board_is_legal(&board));
 
     for (i = 0; i < block_size; i++) {
         for (j = 0; j < block_size; j++) {
-            assert(!cell_is_empty(board_access(&board, i, j)));
+            assert(board_get_value(&board, i, j));
         }
     }
 
     board_destroy(&board);
     board_init(&board, 2, 2);
 
-    VAL(0, 0) = 1;
-    VAL(0, 1) = 2;
-    VAL(1, 0) = 3;
-    VAL(1, 1) = 4;
-    VAL(0, 2) = 3;
-    VAL(0, 3) = 4;
-    VAL(1, 2) = 1;
-    VAL(2, 3) = 2;
+    SET(0, 0, 1);
+    SET(0, 1, 2);
+    SET(1, 0, 3);
+    SET(1, 1, 4);
+    SET(0, 2, 3);
+    SET(0, 3, 4);
+    SET(1, 2, 1);
+    SET(2, 3, 2);
 
     board_print(&board, stderr, FALSE);
     assert(board_is_legal(&board));
@@ -67,14 +80,14 @@ int main() {
     assert(lp_validate_ilp(env, &board) == LP_INFEASIBLE);
     assert(lp_solve_ilp(env, &board) == LP_INFEASIBLE);
 
-    VAL(1, 3) = 3;
-    VAL(2, 0) = 2;
-    VAL(2, 1) = 3;
-    VAL(2, 2) = 4;
-    VAL(3, 0) = 4;
-    VAL(3, 1) = 3;
-    VAL(3, 2) = 2;
-    VAL(3, 3) = 1;
+    SET(1, 3, 3);
+    SET(2, 0, 2);
+    SET(2, 1, 3);
+    SET(2, 2, 4);
+    SET(3, 0, 4);
+    SET(3, 1, 3);
+    SET(3, 2, 2);
+    SET(3, 3, 1);
 
     board_print(&board, stderr, FALSE);
     assert(!board_is_legal(&board));
@@ -83,7 +96,155 @@ int main() {
     assert(lp_validate_ilp(env, &board) == LP_SUCCESS);
     assert(lp_solve_ilp(env, &board) == LP_SUCCESS);
 
+    board_destroy(&board);
+}
+
+static void test_lp_presolve(lp_env_t env) {
+    board_t board;
+    lp_stats_t stats;
+
+    board_init(&board, 2, 2);
+
+    /* (0, 3) is a naked single, after which every cell is forced. */
+    SET(0, 0, 1);
+    SET(0, 1, 2);
+    SET(0, 2, 3);
+    SET(1, 0, 3);
+    SET(2, 1, 1);
+    SET(3, 2, 2);
+
+    lp_env_reset_stats(env);
+    assert(lp_solve_ilp(env, &board) == LP_SUCCESS);
+    assert(board_is_legal(&board));
+    assert(board_get_value(&board, 0, 3) == 4);
+
+    lp_env_stats(env, &stats);
+    assert(stats.solves == 1);
+    assert(stats.fixed_cells == 10);
+    assert(stats.removed_vars > 0 && stats.removed_constrs > 0);
+    assert(stats.presolve_infeasible == 0);
+
+    board_destroy(&board);
+    board_init(&board, 2, 2);
+
+    /* Every candidate of (1, 3) is placed in its row or column. */
+    SET(0, 0, 1);
+    SET(1, 0, 3);
+    SET(1, 1, 4);
+    SET(1, 2, 1);
+    SET(2, 3, 2);
+
+    lp_env_reset_stats(env);
+    assert(lp_validate_ilp(env, &board) == LP_INFEASIBLE);
+
+    lp_env_stats(env, &stats);
+    assert(stats.presolve_infeasible == 1);
+
+    board_destroy(&board);
+}
+
+/**
+ * Check that every empty cell of `board` holds exactly one value in total
+ * across `candidate_board`, and release the candidates.
+ */
+static void check_candidates(const board_t* board,
+                             lp_cell_candidates_t* candidate_board) {
+    int block_size = board_block_size(board);
+    int i, j;
+
+    for (i = 0; i < block_size; i++) {
+        for (j = 0; j < block_size; j++) {
+            lp_cell_candidates_t* candidates =
+                &candidate_board[i * block_size + j];
+            double total = 0.0;
+            int k;
+
+            for (k = 0; k < candidates->size; k++) {
+                total += candidates->candidates[k].score;
+            }
+
+            if (!board_get_value(board, i, j)) {
+                assert(fabs(total - 1.0) < 1e-6);
+            }
+            lp_cell_candidates_destroy(candidates);
+        }
+    }
+}
+
+static void test_lp_geometries(lp_env_t env) {
+    /* Revisit geometries after solving others in between, with more distinct
+     * geometries than the Gurobi backend keeps live models for, so that
+     * models are both reused and evicted and rebuilt. */
+    const int geometries[][2] = {{3, 3}, {2, 3}, {3, 3}, {2, 2},
+                                 {3, 2}, {2, 4}, {3, 3}, {2, 3}};
+    int step;
+
+    for (step = 0; step < (int)(sizeof(geometries) / sizeof(geometries[0]));
+         step++) {
+        lp_cell_candidates_t candidate_board[81];
+        board_t board;
+        int block_size;
+        int first = step % 3 + 1;
+        int second = step % 3 + 2;
+        int i, j;
+
+        board_init(&board, geometries[step][0], geometries[step][1]);
+        block_size = board_block_size(&board);
+
+        /* Different givens at every step, so that a reused model has to be
+         * restricted to the new board. */
+        SET(0, 0, first);
+        SET(block_size - 1, step % 2, second);
+
+        /* Alternate the order of continuous and integer solves. */
+        if (step % 2) {
+            assert(lp_solve_continuous(env, &board, candidate_board) ==
+                   LP_SUCCESS);
+            check_candidates(&board, candidate_board);
+        }
+
+        assert(lp_solve_ilp(env, &board) == LP_SUCCESS);
+        assert(board_is_legal(&board));
+        assert(board_get_value(&board, 0, 0) == first);
+        assert(board_get_value(&board, block_size - 1, step % 2) == second);
+        for (i = 0; i < block_size; i++) {
+            for (j = 0; j < block_size; j++) {
+                assert(board_get_value(&board, i, j));
+            }
+        }
+
+        if (!(step % 2)) {
+            SET(1, 1, 0);
+            assert(lp_solve_continuous(env, &board, candidate_board) ==
+                   LP_SUCCESS);
+            check_candidates(&board, candidate_board);
+        }
+
+        board_destroy(&board);
+    }
+}
+
+int main() {
+    lp_env_t env;
+
+    assert(lp_env_create_backend(&env, "native"));
+    assert(!strcmp(lp_env_backend_name(env), "native"));
+    test_lp_env(env);
+    test_lp_presolve(env);
+    test_lp_geometries(env);
+
+    lp_env_set_presolve(env, FALSE);
+    test_lp_env(env);
     lp_env_free(env);
 
+    /* Gurobi may be missing or unlicensed. */
+    if (lp_env_create_backend(&env, "gurobi")) {
+        test_lp_env(env);
+        test_lp_geometries(env);
+        lp_env_free(env);
+    }
+
+    assert(!lp_env_create_backend(&env, "missing"));
+
     return 0;
 }
@@ -0,0 +1,159 @@
+#include "lp_model.h"
+
+#include "board.h"
+#include <assert.h>
+#include <stdlib.h>
+
+#define SET(row, col, val) board_set_value(&board, row, col, val)
+
+/**
+ * Check that restricting the template of `board`'s geometry to `board` yields
+ * the model built from `board` directly.
+ */
+static void check_restrict(const board_t* board) {
+    lp_model_t template;
+    lp_model_t model;
+    double* ub;
+    double* rhs;
+    double* obj;
+    int block_size = board_block_size(board);
+    int var_count = 0;
+    int constr_count = 0;
+    int size_var_count, size_constr_count;
+    int idx, val, i;
+
+    lp_model_init_template(&template, board->m, board->n,
+                           board_get_layout(board));
+    assert(template.var_count == block_size * block_size * block_size);
+    assert(template.constr_count == (1 + UK_COUNT) * block_size * block_size);
+
+    ub = calloc(template.var_count, sizeof(double));
+    rhs = calloc(template.constr_count, sizeof(double));
+    obj = calloc(template.var_count, sizeof(double));
+    lp_model_restrict(&template, board, ub, rhs, obj);
+
+    assert(lp_model_init(&model, board));
+    lp_model_size(board, &size_var_count, &size_constr_count);
+    assert(size_var_count == model.var_count);
+    assert(size_constr_count == model.constr_count);
+
+    for (idx = 0; idx < block_size * block_size; idx++) {
+        for (val = 1; val <= block_size; val++) {
+            int var_idx = lp_model_var(&model, idx, val);
+            int template_idx = lp_model_var(&template, idx, val);
+
+            if (var_idx == -1) {
+                assert(ub[template_idx] == 0.0);
+            } else {
+                assert(ub[template_idx] == 1.0);
+                assert(obj[template_idx] == model.obj[var_idx]);
+                var_count++;
+            }
+        }
+    }
+
+    /* Every variable is found again by its cell and value. */
+    for (idx = 0; idx < block_size * block_size; idx++) {
+        for (i = model.cell_start[idx]; i < model.cell_start[idx + 1]; i++) {
+            assert(lp_model_var(&model, idx, model.var_vals[i]) == i);
+        }
+    }
+
+    for (i = 0; i < template.constr_count; i++) {
+        if (rhs[i] == 1.0) {
+            constr_count++;
+        }
+    }
+
+    assert(var_count == model.var_count);
+    assert(constr_count == model.constr_count);
+
+    lp_model_destroy(&model);
+    free(obj);
+    free(rhs);
+    free(ub);
+    lp_model_destroy(&template);
+}
+
+static void test_lp_model_restrict(void) {
+    board_t board;
+
+    board_init(&board, 3, 3);
+    check_restrict(&board);
+
+    SET(0, 0, 1);
+    SET(5, 7, 3);
+    SET(8, 8, 9);
+    check_restrict(&board);
+
+    board_destroy(&board);
+    board_init_layout(&board, 2, 3, BL_BLOCK_MAJOR);
+
+    SET(0, 0, 1);
+    SET(1, 4, 2);
+    SET(3, 3, 6);
+    check_restrict(&board);
+
+    board_destroy(&board);
+}
+
+static void test_lp_model_unsolvable(void) {
+    board_t board;
+    lp_model_t template;
+    lp_model_t model;
+    double ub[64];
+    double rhs[64];
+    double obj[64];
+
+    board_init(&board, 2, 2);
+
+    /* Cell (0, 3) has no candidates left. */
+    SET(0, 0, 1);
+    SET(0, 1, 2);
+    SET(0, 2, 3);
+    SET(3, 3, 4);
+
+    assert(!lp_model_init(&model, &board));
+
+    lp_model_init_template(&template, 2, 2, BL_ROW_MAJOR);
+    lp_model_restrict(&template, &board, ub, rhs, obj);
+
+    /* Its constraint is kept, with no variables left to satisfy it. */
+    assert(rhs[3] == 1.0);
+    assert(ub[lp_model_var(&template, 3, 4)] == 0.0);
+
+    lp_model_destroy(&template);
+    board_destroy(&board);
+}
+
+static void test_lp_template_cache(void) {
+    lp_template_cache_t cache;
+    board_t a, b, c;
+    const lp_model_t* template;
+
+    board_init(&a, 3, 3);
+    board_init(&b, 3, 3);
+    board_init_layout(&c, 3, 3, BL_BLOCK_MAJOR);
+    board_set_value(&b, 0, 0, 1);
+
+    lp_template_cache_init(&cache);
+
+    /* Templates depend only on the geometry, not on the board's contents. */
+    template = lp_template_cache_get(&cache, &a);
+    assert(template->var_count == 9 * 9 * 9);
+    assert(lp_template_cache_get(&cache, &b) == template);
+    assert(lp_template_cache_get(&cache, &c) != template);
+    assert(lp_template_cache_get(&cache, &a) == template);
+
+    lp_template_cache_destroy(&cache);
+    board_destroy(&c);
+    board_destroy(&b);
+    board_destroy(&a);
+}
+
+int main() {
+    test_lp_model_restrict();
+    test_lp_model_unsolvable();
+    test_lp_template_cache();
+    return 0;
+}
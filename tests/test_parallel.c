@@ -0,0 +1,72 @@
+#include "parallel.h"
+
+#include "backtrack.h"
+#include "board.h"
+#include <assert.h>
+
+static void check_counts(board_t* board) {
+    long expected = num_solutions(board);
+    int threads;
+
+    for (threads = 1; threads <= 8; threads *= 2) {
+        assert(parallel_count(board, threads) == expected);
+    }
+    assert(parallel_count(board, 3) == expected);
+}
+
+static void test_parallel_empty(void) {
+    board_t board;
+
+    board_init(&board, 2, 2);
+    check_counts(&board);
+    assert(parallel_count(&board, 4) == 288);
+    board_destroy(&board);
+}
+
+static void test_parallel_first_row(void) {
+    board_t board;
+    int col;
+
+    board_init(&board, 2, 3);
+    for (col = 0; col < 6; col++) {
+        board_set_value(&board, 0, col, col + 1);
+    }
+    check_counts(&board);
+    board_destroy(&board);
+}
+
+static void test_parallel_trivial(void) {
+    board_t board;
+
+    /* Conflicting boards */
+    board_init(&board, 2, 2);
+    board_set_value(&board, 0, 0, 1);
+    board_set_value(&board, 0, 1, 1);
+    assert(parallel_count(&board, 4) == 0);
+
+    /* Boards with a single empty cell */
+    board_set_value(&board, 0, 1, 2);
+    board_set_value(&board, 0, 2, 3);
+    board_set_value(&board, 0, 3, 4);
+    board_set_value(&board, 1, 0, 3);
+    board_set_value(&board, 1, 1, 4);
+    board_set_value(&board, 1, 2, 1);
+    board_set_value(&board, 1, 3, 2);
+    board_set_value(&board, 2, 0, 2);
+    board_set_value(&board, 2, 1, 1);
+    board_set_value(&board, 2, 2, 4);
+    board_set_value(&board, 2, 3, 3);
+    board_set_value(&board, 3, 0, 4);
+    board_set_value(&board, 3, 1, 3);
+    board_set_value(&board, 3, 2, 2);
+    assert(parallel_count(&board, 4) == 1);
+
+    board_destroy(&board);
+}
+
+int main() {
+    test_parallel_empty();
+    test_parallel_first_row();
+    test_parallel_trivial();
+    return 0;
+}
@@ -669,6 +669,10 @@ static void test_parsing_guess_hint(void) {
 
 static void test_parsing_num_solutions(void) {
     const char num_solutions[] = "num_solutions";
+    const char num_solutions_limit[] = "num_solutions 2";
+    const char num_solutions_zero[] = "num_solutions 0";
+    const char num_solutions_str[] = "num_solutions many";
+    const char num_solutions_two_args[] = "num_solutions 1 2";
     FILE* stream;
     command_t cmd;
 
@@ -685,6 +689,26 @@ static void test_parsing_num_solutions(void) {
     stream = fill_stream(num_solutions);
     assert(parse_line(stream, &cmd, GM_SOLVE) == P_SUCCESS);
     assert(cmd.type == CT_NUM_SOLUTIONS);
+    assert(cmd.arg.int_val == 0);
+    fclose(stream);
+
+    stream = fill_stream(num_solutions_limit);
+    assert(parse_line(stream, &cmd, GM_SOLVE) == P_SUCCESS);
+    assert(cmd.type == CT_NUM_SOLUTIONS);
+    assert(cmd.arg.int_val == 2);
+    fclose(stream);
+
+    stream = fill_stream(num_solutions_zero);
+    assert(parse_line(stream, &cmd, GM_EDIT) == P_INVALID_ARGUMENTS);
+    assert(cmd.type == CT_NUM_SOLUTIONS);
+    fclose(stream);
+
+    stream = fill_stream(num_solutions_str);
+    assert(parse_line(stream, &cmd, GM_EDIT) == P_INVALID_ARGUMENTS);
+    fclose(stream);
+
+    stream = fill_stream(num_solutions_two_args);
+    assert(parse_line(stream, &cmd, GM_EDIT) == P_INVALID_NUM_OF_ARGS);
     fclose(stream);
 }
 
@@ -0,0 +1,145 @@
+#include "search.h"
+
+#include "board.h"
+#include <assert.h>
+#include <stdio.h>
+
+/**
+ * Count the solutions of `board` with a fresh search.
+ */
+static long count(const board_t* board) {
+    search_t search;
+    long ret;
+
+    search_init(&search, board);
+    ret = search_count(&search);
+
+    /* Searches should be reusable. */
+    assert(search_count(&search) == ret);
+    assert(search.trail_size == 0 && search.depth == 0);
+
+    search_destroy(&search);
+    return ret;
+}
+
+static void load(board_t* board, const char* rows[]) {
+    int block_size = board_block_size(board);
+    int row, col;
+
+    for (row = 0; row < block_size; row++) {
+        for (col = 0; col < block_size; col++) {
+            char c = rows[row][col];
+            board_set_value(board, row, col, c == '.' ? 0 : c - '0');
+        }
+    }
+}
+
+static void test_search_unique(void) {
+    /* A puzzle requiring more than singles to solve */
+    const char* rows[] = {"8........", "..36.....", ".7..9.2..",
+                          ".5...7...", "....457..", "...1...3.",
+                          "..1....68", "..85...1.", ".9....4.."};
+    board_t board;
+
+    board_init(&board, 3, 3);
+    load(&board, rows);
+    assert(count(&board) == 1);
+
+    /* Removing clues adds solutions */
+    board_set_value(&board, 0, 0, 0);
+    assert(count(&board) > 1);
+
+    board_destroy(&board);
+}
+
+static void test_search_first_row(void) {
+    board_t board;
+    int col;
+
+    /* There are 28200960 6x6 grids, evenly split across the 720 possible first
+     * rows. */
+    board_init(&board, 2, 3);
+    for (col = 0; col < 6; col++) {
+        board_set_value(&board, 0, col, col + 1);
+    }
+    assert(count(&board) == 28200960 / 720);
+
+    board_destroy(&board);
+}
+
+static void test_search_conflicts(void) {
+    board_t board;
+
+    board_init(&board, 2, 2);
+    board_set_value(&board, 0, 0, 1);
+    board_set_value(&board, 3, 0, 1);
+    assert(count(&board) == 0);
+
+    board_destroy(&board);
+}
+
+static void test_search_block_major(void) {
+    board_t board;
+
+    board_init_layout(&board, 2, 2, BL_BLOCK_MAJOR);
+    assert(count(&board) == 288);
+
+    board_set_value(&board, 0, 0, 1);
+    board_set_value(&board, 1, 2, 1);
+    assert(count(&board) == 288 / 4 / 2);
+
+    board_destroy(&board);
+}
+
+static long count_cached(const board_t* board, search_tt_t* tt) {
+    search_t search;
+    long ret;
+
+    search_init(&search, board);
+    assert(search.hash == board_hash(board));
+    search_set_tt(&search, tt);
+    ret = search_count(&search);
+    assert(search.hash == board_hash(board));
+    search_destroy(&search);
+
+    return ret;
+}
+
+static void test_search_tt(void) {
+    const int cells[][3] = {{1, 0, 4}, {2, 0, 2}, {3, 3, 1}, {4, 4, 3}};
+    board_t board;
+    search_tt_t tt;
+    int col;
+    int i;
+
+    board_init(&board, 2, 3);
+    for (col = 0; col < 6; col++) {
+        board_set_value(&board, 0, col, col + 1);
+    }
+
+    search_tt_init(&tt, 12);
+    assert(count_cached(&board, &tt) == 28200960 / 720);
+
+    /* Later counts reuse subproblems counted earlier. */
+    for (i = 0; i < 4; i++) {
+        board_set_value(&board, cells[i][0], cells[i][1], cells[i][2]);
+        assert(count_cached(&board, &tt) == count(&board));
+    }
+    assert(tt.hits > 0);
+
+    search_tt_clear(&tt);
+    assert(tt.hits == 0);
+    assert(count_cached(&board, &tt) == count(&board));
+
+    search_tt_destroy(&tt);
+    board_destroy(&board);
+}
+
+int main() {
+    test_search_unique();
+    test_search_first_row();
+    test_search_conflicts();
+    test_search_block_major();
+    test_search_tt();
+    return 0;
+}
@@ -0,0 +1,274 @@
+#include "shard.h"
+
+#include "backtrack.h"
+#include "board.h"
+#include "bool.h"
+#include "search.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST_PATH "test_shard.txt"
+
+static void load(board_t* board, const char* rows[]) {
+    int block_size = board_block_size(board);
+    int row, col;
+
+    for (row = 0; row < block_size; row++) {
+        for (col = 0; col < block_size; col++) {
+            char c = rows[row][col];
+            board_set_value(board, row, col, c == '.' ? 0 : c - '0');
+        }
+    }
+}
+
+/**
+ * Replay `prefix` on `search`, returning the cell chosen next (-1 if the
+ * prefix is solved) or -2 if the prefix leads to a contradiction.
+ */
+static int replay(search_t* search, const shard_prefix_t* prefix) {
+    int best;
+    int i;
+
+    search_reset(search);
+    for (i = 0; i < prefix->depth; i++) {
+        if (!search_place(search, prefix->cells[i], prefix->values[i])) {
+            return -2;
+        }
+    }
+
+    return search_propagate(search, &best) ? best : -2;
+}
+
+/**
+ * Check that no prefix extends another: two prefixes must branch on the same
+ * cell and differ in the value placed there.
+ */
+static void check_disjoint(const shard_prefix_t* a, const shard_prefix_t* b) {
+    int i;
+
+    for (i = 0; i < a->depth && i < b->depth; i++) {
+        assert(a->cells[i] == b->cells[i]);
+        if (a->values[i] != b->values[i]) {
+            return;
+        }
+    }
+
+    assert(!"one prefix extends another");
+}
+
+/**
+ * Enumerate at least `min_count` prefixes of `board` and check that they are
+ * pairwise disjoint and, between them, hold every solution. Returns the number
+ * of prefixes, storing them in `*prefixes`.
+ */
+static int check_enumerate(board_t* board, int min_count,
+                           shard_prefix_t** prefixes) {
+    search_t search;
+    long sum = 0;
+    int count;
+    int i;
+    int j;
+
+    count = shard_enumerate(board, min_count, prefixes);
+    search_init(&search, board);
+
+    for (i = 0; i < count; i++) {
+        const shard_prefix_t* prefix = &(*prefixes)[i];
+
+        assert(prefix->depth >= 0 && prefix->depth <= SHARD_MAX_DEPTH);
+        for (j = 0; j < i; j++) {
+            check_disjoint(&(*prefixes)[j], prefix);
+        }
+
+        if (replay(&search, prefix) != -2) {
+            sum += search_count(&search);
+        }
+    }
+
+    /* Disjoint subtrees hold every solution exactly when their counts sum to
+     * the total. */
+    assert(sum == num_solutions(board));
+
+    search_destroy(&search);
+    return count;
+}
+
+static void test_shard_enumerate(void) {
+    board_t board;
+    shard_prefix_t* prefixes;
+    int min_counts[] = {1, 2, 10, 100, 1000};
+    int count;
+    int col;
+    int i;
+
+    board_init(&board, 2, 3);
+    for (col = 0; col < 6; col++) {
+        board_set_value(&board, 0, col, col + 1);
+    }
+
+    count = check_enumerate(&board, 1, &prefixes);
+    assert(count == 1 && prefixes[0].depth == 0);
+    free(prefixes);
+
+    for (i = 0; i < (int)(sizeof(min_counts) / sizeof(min_counts[0])); i++) {
+        count = check_enumerate(&board, min_counts[i], &prefixes);
+        assert(count >= min_counts[i]);
+        free(prefixes);
+    }
+
+    /* Prefixes ruled out by propagation are dropped. */
+    board_set_value(&board, 1, 0, 1);
+    count = check_enumerate(&board, 10, &prefixes);
+    assert(count == 0);
+    free(prefixes);
+
+    board_destroy(&board);
+}
+
+static void test_shard_solved(void) {
+    const char* rows[] = {"1234", "3412", "2143", "4321"};
+    board_t board;
+    shard_prefix_t* prefixes;
+    search_t search;
+    bool_t shallow = FALSE;
+    int count;
+    int i;
+
+    /* Asking for more prefixes than there are solutions expands the whole
+     * tree, with solved prefixes carried over unchanged while the rest are
+     * split further. */
+    board_init(&board, 2, 2);
+    count = check_enumerate(&board, 1000, &prefixes);
+    assert(count == 288);
+
+    search_init(&search, &board);
+    for (i = 0; i < count; i++) {
+        assert(replay(&search, &prefixes[i]) == -1);
+        shallow = shallow || prefixes[i].depth < prefixes[count - 1].depth;
+    }
+    assert(shallow);
+    search_destroy(&search);
+    free(prefixes);
+
+    /* A solved board is a single, empty prefix. */
+    load(&board, rows);
+    count = check_enumerate(&board, 10, &prefixes);
+    assert(count == 1 && prefixes[0].depth == 0);
+    free(prefixes);
+
+    board_destroy(&board);
+}
+
+static void test_shard_max_depth(void) {
+    /* A puzzle with 628 prefixes at SHARD_MAX_DEPTH, some still unsolved. */
+    const char* rows[] = {"8........", "..36.....", ".7..9.2..",
+                          ".5...7...", "....457..", "...1...3.",
+                          "..1....68", "...5...1.", ".9....4.."};
+    board_t board;
+    shard_prefix_t* prefixes;
+    search_t search;
+    int unsolved = 0;
+    int count;
+    int i;
+
+    board_init(&board, 3, 3);
+    load(&board, rows);
+
+    /* Enumeration stops at the maximum depth, short of the requested count. */
+    count = check_enumerate(&board, 1000, &prefixes);
+    assert(count < 1000);
+
+    search_init(&search, &board);
+    for (i = 0; i < count; i++) {
+        if (prefixes[i].depth == SHARD_MAX_DEPTH &&
+            replay(&search, &prefixes[i]) >= 0) {
+            unsolved++;
+        }
+    }
+    assert(unsolved > 0);
+    search_destroy(&search);
+    free(prefixes);
+
+    board_destroy(&board);
+}
+
+static void test_shard_count(void) {
+    board_t board;
+    int totals[] = {1, 2, 3, 7, 50};
+    long expected;
+    int col;
+    int t;
+
+    board_init(&board, 2, 3);
+    for (col = 0; col < 6; col++) {
+        board_set_value(&board, 0, col, col + 1);
+    }
+    expected = num_solutions(&board);
+
+    for (t = 0; t < (int)(sizeof(totals) / sizeof(totals[0])); t++) {
+        int total = totals[t];
+        long sum = 0;
+        int i;
+
+        for (i = 0; i < total; i++) {
+            sum += shard_count(&board, i, total);
+        }
+        assert(sum == expected);
+    }
+
+    board_destroy(&board);
+}
+
+static void merge_text(const char* text, shard_merge_status_t expected,
+                       long expected_count) {
+    shard_merge_t merge;
+    shard_merge_status_t status;
+    FILE* stream;
+    long count = -1;
+
+    stream = fopen(TEST_PATH, "w");
+    assert(stream);
+    fputs(text, stream);
+    fclose(stream);
+
+    stream = fopen(TEST_PATH, "r");
+    assert(stream);
+
+    shard_merge_init(&merge);
+    status = shard_merge_read(&merge, stream);
+    if (status == SM_OK) {
+        status = shard_merge_finish(&merge, &count);
+    }
+    shard_merge_destroy(&merge);
+
+    fclose(stream);
+    remove(TEST_PATH);
+
+    assert(status == expected);
+    if (status == SM_OK) {
+        assert(count == expected_count);
+    }
+}
+
+static void test_shard_merge(void) {
+    merge_text("shard 1/3 count 5\nshard 0/3 count 7\nshard 2/3 count 0\n",
+               SM_OK, 12);
+    merge_text("shard 0/2 count 3000000000\nshard 1/2 count 3000000000\n",
+               SM_OK, 6000000000L);
+    merge_text("shard 0/2 count 5\n", SM_ERR_MISSING, 0);
+    merge_text("", SM_ERR_MISSING, 0);
+    merge_text("shard 0/2 count 5\nshard 0/2 count 5\n", SM_ERR_DUPLICATE, 0);
+    merge_text("shard 0/2 count 5\nshard 1/3 count 5\n", SM_ERR_MISMATCH, 0);
+    merge_text("shard 2/2 count 5\n", SM_ERR_FMT, 0);
+    merge_text("shard 0/1 count x\n", SM_ERR_FMT, 0);
+}
+
+int main() {
+    test_shard_enumerate();
+    test_shard_solved();
+    test_shard_max_depth();
+    test_shard_count();
+    test_shard_merge();
+    return 0;
+}
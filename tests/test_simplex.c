@@ -0,0 +1,197 @@
+#include "simplex.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+
+#define EPSILON 1e-6
+
+static int close_to(double a, double b) { return fabs(a - b) < EPSILON; }
+
+static void test_simplex_optimal(void) {
+    /* minimize -x0 - 2 x1 subject to x0 + x1 + s = 3, x0 <= 2, x1 <= 2 */
+    int row_start[] = {0, 3};
+    int row_cols[] = {0, 1, 2};
+    double rhs[] = {3};
+    double cost[] = {-1, -2, 0};
+    double upper[] = {2, 2, HUGE_VAL};
+    double x[3];
+    simplex_problem_t problem;
+
+    problem.rows = 1;
+    problem.cols = 3;
+    problem.row_start = row_start;
+    problem.row_cols = row_cols;
+    problem.row_values = NULL;
+    problem.rhs = rhs;
+    problem.cost = cost;
+    problem.upper = upper;
+
+    assert(simplex_solve(&problem, x) == SIMPLEX_OPTIMAL);
+    assert(close_to(x[0], 1) && close_to(x[1], 2) && close_to(x[2], 0));
+}
+
+static void test_simplex_coefficients(void) {
+    /* minimize x0 + x1 subject to 2 x0 - x1 = -1, x0 + x1 - x2 = 2 */
+    int row_start[] = {0, 2, 5};
+    int row_cols[] = {0, 1, 0, 1, 2};
+    double row_values[] = {2, -1, 1, 1, -1};
+    double rhs[] = {-1, 2};
+    double cost[] = {1, 1, 0};
+    double upper[] = {HUGE_VAL, HUGE_VAL, HUGE_VAL};
+    double x[3];
+    simplex_problem_t problem;
+
+    problem.rows = 2;
+    problem.cols = 3;
+    problem.row_start = row_start;
+    problem.row_cols = row_cols;
+    problem.row_values = row_values;
+    problem.rhs = rhs;
+    problem.cost = cost;
+    problem.upper = upper;
+
+    assert(simplex_solve(&problem, x) == SIMPLEX_OPTIMAL);
+    assert(close_to(x[0] + x[1], 2) && close_to(x[2], 0));
+    assert(close_to(2 * x[0] - x[1], -1));
+
+    /* Dropping the cost of x2 leaves the objective unbounded. */
+    cost[0] = 0;
+    cost[1] = 0;
+    cost[2] = -1;
+    assert(simplex_solve(&problem, x) == SIMPLEX_UNBOUNDED);
+}
+
+static void test_simplex_redundant(void) {
+    /* The 2x2 assignment polytope, whose last constraint is redundant:
+     * x00 + x01 = 1, x10 + x11 = 1, x00 + x10 = 1, x01 + x11 = 1 */
+    int row_start[] = {0, 2, 4, 6, 8};
+    int row_cols[] = {0, 1, 2, 3, 0, 2, 1, 3};
+    double rhs[] = {1, 1, 1, 1};
+    double cost[] = {1, 3, 2, 1};
+    double upper[] = {1, 1, 1, 1};
+    double x[4];
+    simplex_problem_t problem;
+
+    problem.rows = 4;
+    problem.cols = 4;
+    problem.row_start = row_start;
+    problem.row_cols = row_cols;
+    problem.row_values = NULL;
+    problem.rhs = rhs;
+    problem.cost = cost;
+    problem.upper = upper;
+
+    assert(simplex_solve(&problem, x) == SIMPLEX_OPTIMAL);
+    assert(close_to(x[0], 1) && close_to(x[1], 0));
+    assert(close_to(x[2], 0) && close_to(x[3], 1));
+
+    /* The columns cannot sum to 3 while the rows sum to 2. */
+    rhs[2] = 2;
+    assert(simplex_solve(&problem, x) == SIMPLEX_INFEASIBLE);
+}
+
+#define ASSIGN_SIZE 16
+
+/**
+ * Compute the cost of the cheapest assignment of every row of `cost` to a
+ * distinct column, by dynamic programming over the sets of used columns.
+ */
+static double best_assignment(const double* cost) {
+    static double best[1 << ASSIGN_SIZE];
+    int set, col;
+
+    best[0] = 0;
+    for (set = 1; set < 1 << ASSIGN_SIZE; set++) {
+        int row = -1;
+        int bits;
+
+        for (bits = set; bits; bits &= bits - 1) {
+            row++;
+        }
+
+        best[set] = HUGE_VAL;
+        for (col = 0; col < ASSIGN_SIZE; col++) {
+            if (set & (1 << col)) {
+                double total =
+                    best[set & ~(1 << col)] + cost[row * ASSIGN_SIZE + col];
+                if (total < best[set]) {
+                    best[set] = total;
+                }
+            }
+        }
+    }
+
+    return best[(1 << ASSIGN_SIZE) - 1];
+}
+
+static void test_simplex_assignment(void) {
+    /* An assignment problem large enough to need several refactorizations of
+     * the basis: x_rc is 1 when row r is assigned column c. */
+    int row_start[2 * ASSIGN_SIZE + 1];
+    int row_cols[2 * ASSIGN_SIZE * ASSIGN_SIZE];
+    double rhs[2 * ASSIGN_SIZE];
+    double cost[ASSIGN_SIZE * ASSIGN_SIZE];
+    double upper[ASSIGN_SIZE * ASSIGN_SIZE];
+    double x[ASSIGN_SIZE * ASSIGN_SIZE];
+    double total = 0;
+    simplex_problem_t problem;
+    int i, j, k = 0;
+
+    for (i = 0; i < ASSIGN_SIZE; i++) {
+        row_start[i] = k;
+        for (j = 0; j < ASSIGN_SIZE; j++) {
+            row_cols[k++] = i * ASSIGN_SIZE + j;
+        }
+    }
+    for (j = 0; j < ASSIGN_SIZE; j++) {
+        row_start[ASSIGN_SIZE + j] = k;
+        for (i = 0; i < ASSIGN_SIZE; i++) {
+            row_cols[k++] = i * ASSIGN_SIZE + j;
+        }
+    }
+    row_start[2 * ASSIGN_SIZE] = k;
+
+    for (i = 0; i < 2 * ASSIGN_SIZE; i++) {
+        rhs[i] = 1;
+    }
+    for (i = 0; i < ASSIGN_SIZE * ASSIGN_SIZE; i++) {
+        cost[i] = (i * 37 + i / ASSIGN_SIZE * 11) % 23;
+        upper[i] = 1;
+    }
+
+    problem.rows = 2 * ASSIGN_SIZE;
+    problem.cols = ASSIGN_SIZE * ASSIGN_SIZE;
+    problem.row_start = row_start;
+    problem.row_cols = row_cols;
+    problem.row_values = NULL;
+    problem.rhs = rhs;
+    problem.cost = cost;
+    problem.upper = upper;
+
+    assert(simplex_solve(&problem, x) == SIMPLEX_OPTIMAL);
+
+    for (i = 0; i < ASSIGN_SIZE * ASSIGN_SIZE; i++) {
+        assert(x[i] > -EPSILON && x[i] < 1 + EPSILON);
+        total += cost[i] * x[i];
+    }
+    for (i = 0; i < 2 * ASSIGN_SIZE; i++) {
+        double sum = 0;
+        for (k = row_start[i]; k < row_start[i + 1]; k++) {
+            sum += x[row_cols[k]];
+        }
+        assert(close_to(sum, 1));
+    }
+
+    /* The assignment polytope is integral, so the LP optimum is the cost of
+     * the best assignment. */
+    assert(close_to(total, best_assignment(cost)));
+}
+
+int main() {
+    test_simplex_optimal();
+    test_simplex_coefficients();
+    test_simplex_redundant();
+    test_simplex_assignment();
+    return 0;
+}